@@ -3,22 +3,26 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <string_view>
 
 inline bool isNumber(char ch) { return 0x30 <= ch && ch < 0x3A; }
 
+int calibrationValue1(std::string_view line) {
+  const char first = *std::find_if(line.begin(), line.end(), &isNumber);
+  const char second = *std::find_if(line.rbegin(), line.rend(), &isNumber);
+  return 10 * (first - 0x30) + (second - 0x30);
+}
+
+// The lines are streamed (see LineReader), so the input may be of any size.
 void solvePart1() {
-  std::ifstream is("input.txt");
-  std::string line;
-  int sum = 0;
-  while (std::getline(is, line)) {
-    const char first = *std::find_if(line.begin(), line.end(), &isNumber);
-    const char second = *std::find_if(line.rbegin(), line.rend(), &isNumber);
-    sum += 10 * (first - 0x30) + (second - 0x30);
-  }
+  LineReader reader(inputPath);
+  long long sum = 0;
+  reader.forEach(
+      [&](std::string_view line) { sum += calibrationValue1(line); });
   std::cout << "Sum: " << sum << "\n";
 }
 
-inline char readDigit(const std::string &line, size_t i, char& out) {
+inline char readDigit(std::string_view line, size_t i, char& out) {
   const char ch = line[i];
   if (isNumber(ch)) {
     out = ch;
@@ -70,7 +74,7 @@ inline char readDigit(const std::string &line, size_t i, char& out) {
   return false;
 }
 
-char findFirst(const std::string &line) {
+char findFirst(std::string_view line) {
   char digit;
   for (size_t i = 0; i < line.size(); ++i) {
     if (readDigit(line, i, digit)) {
@@ -80,7 +84,7 @@ char findFirst(const std::string &line) {
   throw std::runtime_error("Error: Found no first digit.\n");
 }
 
-char findSecond(const std::string &line) {
+char findSecond(std::string_view line) {
   char digit;
   for (int i = static_cast<int>(line.size()) - 1; i >= 0; --i) {
     if (readDigit(line, i, digit)) {
@@ -90,43 +94,50 @@ char findSecond(const std::string &line) {
   throw std::runtime_error("Error: Found no second digit.\n");
 }
 
+int calibrationValue2(std::string_view line) {
+  const char first = findFirst(line);
+  const char second = findSecond(line);
+  //std::cout << first << second << "\n";
+  return 10 * (first - 0x30) + (second - 0x30);
+}
+
 // Faster solution of part 2.
 void solvePart2() {
-  std::ifstream is("input.txt");
-  std::string line;
-  int sum = 0;
-  while (std::getline(is, line)) {
-    const char first = findFirst(line);
-    const char second = findSecond(line);
-    //std::cout << first << second << "\n";
-    sum += 10 * (first - 0x30) + (second - 0x30);
-  }
+  LineReader reader(inputPath);
+  long long sum = 0;
+  reader.forEach(
+      [&](std::string_view line) { sum += calibrationValue2(line); });
   std::cout << "Sum: " << sum << "\n";
 }
 
 inline void replaceString(std::string& line, const std::string& searchedString, const std::string& replacedString)
 {
   auto pos = line.find(searchedString);
-  if (pos != std::string::npos) {
+  while (pos != std::string::npos) {
     line.replace(pos, searchedString.size(), replacedString);
+    pos = line.find(searchedString, pos + replacedString.size());
   }
 }
 
 // Slower but easier to implement solution of part 2.
 void solvePart2Replace() {
-  std::ifstream is("input.txt");
+  LineReader reader(inputPath);
   std::string line;
-  int sum = 0;
-  while (std::getline(is, line)) {
-    replaceString(line, "one", "1");
-    replaceString(line, "two", "2");
-    replaceString(line, "three", "3");
-    replaceString(line, "four", "4");
-    replaceString(line, "five", "5");
-    replaceString(line, "six", "6");
-    replaceString(line, "seven", "7");
-    replaceString(line, "eight", "8");
-    replaceString(line, "nine", "9");
+  long long sum = 0;
+  std::string_view lineView;
+  while (reader.next(lineView)) {
+    line.assign(lineView);
+    // Keep the first and last letter, they may be part of an overlapping
+    // word like in "eightwo".
+    replaceString(line, "one", "o1e");
+    replaceString(line, "two", "t2o");
+    replaceString(line, "three", "t3e");
+    replaceString(line, "four", "f4r");
+    replaceString(line, "five", "f5e");
+    replaceString(line, "six", "s6x");
+    replaceString(line, "seven", "s7n");
+    replaceString(line, "eight", "e8t");
+    replaceString(line, "nine", "n9e");
     const char first = *std::find_if(line.begin(), line.end(), &isNumber);
     const char second = *std::find_if(line.rbegin(), line.rend(), &isNumber);
     sum += 10 * (first - 0x30) + (second - 0x30);
@@ -134,9 +145,31 @@ void solvePart2Replace() {
   std::cout << "Sum: " << sum << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  long long sum1 = 0;
+  long long sum2 = 0;
+  reader.forEach([&](std::string_view line) {
+    sum1 += calibrationValue1(line);
+    sum2 += calibrationValue2(line);
+  });
+  std::cout << "Sum: " << sum1 << "\n";
+  std::cout << "Sum: " << sum2 << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   //measureTime(&solvePart2Replace, "Part 2 (replacing)");
   std::cout << "Done.\n";
   return 0;
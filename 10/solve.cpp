@@ -1,9 +1,11 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <vector>
 
 const std::string eastConnection = "-LF";
@@ -11,30 +13,21 @@ const std::string westConnection = "-J7";
 const std::string southConnection = "|7F";
 const std::string northConnection = "|LJ";
 
-using Map = std::vector<std::string>;
-using Coords = std::array<int, 2>;
-
-void parseMap(std::ifstream &ifs, Map &map) {
-  std::string line;
-  while (std::getline(ifs, line)) {
-    map.push_back(line);
-  }
-}
+// The border is empty ground for Map and marked as visited ('#') for
+// ScaledMap, so looking at neighbours needs no bounds checks.
+using Map = Grid<char>;
+using ScaledMap = Grid<char>;
+using Coords = Coords_<int>;
 
 Coords findStartCoords(const Map &map) {
-  Coords startCoords; // row, col
-  bool found = false;
-  for (size_t row = 0; row < map.size() && !found; ++row) {
-    const auto &line = map[row];
-    for (size_t col = 0; col < line.size() && !found; ++col) {
-      if (line[col] == 'S') {
-        startCoords = {static_cast<int>(row), static_cast<int>(col)};
-        found = true;
+  for (int row = 0; row < map.rows(); ++row) {
+    for (int col = 0; col < map.cols(); ++col) {
+      if (map(row, col) == 'S') {
+        return Coords(row, col);
       }
     }
   }
-  assert(found);
-  return startCoords;
+  throw std::runtime_error("Found no start");
 }
 
 bool isA(const std::string &connections, char ch) {
@@ -46,30 +39,30 @@ std::vector<Coords> findStartConnections(const Map &map,
   std::vector<Coords> connections;
   // Left
   {
-    char left = map[startCoords[0]][startCoords[1] - 1];
-    if (isA(eastConnection, left)) {
-      connections.push_back({startCoords[0], startCoords[1] - 1});
+    const Coords left = startCoords + Coords::Left();
+    if (isA(eastConnection, map[left])) {
+      connections.push_back(left);
     }
   }
   // Right
   {
-    char right = map[startCoords[0]][startCoords[1] + 1];
-    if (isA(westConnection, right)) {
-      connections.push_back({startCoords[0], startCoords[1] + 1});
+    const Coords right = startCoords + Coords::Right();
+    if (isA(westConnection, map[right])) {
+      connections.push_back(right);
     }
   }
   // Up
   {
-    char up = map[startCoords[0] - 1][startCoords[1]];
-    if (isA(southConnection, up)) {
-      connections.push_back({startCoords[0] - 1, startCoords[1]});
+    const Coords up = startCoords + Coords::Up();
+    if (isA(southConnection, map[up])) {
+      connections.push_back(up);
     }
   }
   // Down
   {
-    char down = map[startCoords[0] + 1][startCoords[1]];
-    if (isA(northConnection, down)) {
-      connections.push_back({startCoords[0] + 1, startCoords[1]});
+    const Coords down = startCoords + Coords::Down();
+    if (isA(northConnection, map[down])) {
+      connections.push_back(down);
     }
   }
   assert(connections.size() == 2);
@@ -77,68 +70,60 @@ std::vector<Coords> findStartConnections(const Map &map,
 }
 
 Coords getNext(const Map &map, const Coords &cur, const Coords &next) {
-  const Coords diff = {next[0] - cur[0], next[1] - cur[1]};
-  const char nextCh = map[next[0]][next[1]];
+  const Coords diff = next - cur;
+  const char nextCh = map[next];
   if (nextCh == '|') {
-    return {next[0] + diff[0], next[1] + diff[1]};
+    return next + diff;
   } else if (nextCh == '-') {
-    return {next[0] + diff[0], next[1] + diff[1]};
+    return next + diff;
   } else if (nextCh == 'L') {
-    return {next[0] + diff[1], next[1] + diff[0]};
+    return next.plus(diff.col, diff.row);
   } else if (nextCh == 'J') {
-    return {next[0] - diff[1], next[1] - diff[0]};
+    return next.plus(-diff.col, -diff.row);
   } else if (nextCh == '7') {
-    return {next[0] + diff[1], next[1] + diff[0]};
+    return next.plus(diff.col, diff.row);
   } else if (nextCh == 'F') {
-    return {next[0] - diff[1], next[1] - diff[0]};
+    return next.plus(-diff.col, -diff.row);
   } else if (nextCh == 'S') {
-    return {0, 0};
+    return Coords(0, 0);
   } else {
-    const char curCh = map[cur[0]][cur[1]];
     throw std::runtime_error("Reached unknown tile");
   }
 }
 
 void solvePart1() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  Map map;
-  parseMap(ifs, map);
+  const InputFile input(inputPath);
+  // const InputFile input("input_test.txt");
+  const Map map = Map::fromLines(input.lines(), '.');
   // Find start.
   const auto startCoords = findStartCoords(map); // row, col
   const auto startConnections = findStartConnections(map, startCoords);
   size_t count = 0;
   Coords cur = startCoords;
   Coords next = startConnections[0];
-  Coords nextNext;
   do {
-    nextNext = getNext(map, cur, next);
-    std::swap(cur, next);
-    std::swap(next, nextNext);
+    const Coords nextNext = getNext(map, cur, next);
+    cur = next;
+    next = nextNext;
     ++count;
-  } while ((cur[0] != startCoords[0]) || (cur[1] != startCoords[1]));
+  } while (cur != startCoords);
   std::cout << "Steps: " << count / 2 << "\n";
 }
 
-Map makeScaledEmptyMap(const Map &map) {
-  Map scaledMap;
-  std::string empty;
-  empty.resize(2 * map[0].size(), ' ');
-  std::string dots = empty;
-  for (size_t i = 0; i < dots.size(); i += 2) {
-    dots[i] = '.';
-  }
-  scaledMap.reserve(map.size() * 2);
-  for (size_t i = 0; i < map.size(); ++i) {
-    scaledMap.push_back(dots);
-    scaledMap.push_back(empty);
+ScaledMap makeScaledEmptyMap(const Map &map) {
+  ScaledMap scaledMap(2 * map.rows(), 2 * map.cols(), '#');
+  scaledMap.fill(' ');
+  for (int row = 0; row < scaledMap.rows(); row += 2) {
+    for (int col = 0; col < scaledMap.cols(); col += 2) {
+      scaledMap(row, col) = '.';
+    }
   }
   return scaledMap;
 }
 
 char getConnector(const Coords &cur, const Coords &next) {
   char ret;
-  if (cur[0] != next[0]) {
+  if (cur.row != next.row) {
     ret = '|';
   } else {
     ret = '-';
@@ -146,91 +131,64 @@ char getConnector(const Coords &cur, const Coords &next) {
   return ret;
 }
 
-inline std::array<Coords, 4> getNeighbors(const Coords &coords) {
-  return {Coords{coords[0], coords[1] - 1}, Coords{coords[0], coords[1] + 1},
-          Coords{coords[0] - 1, coords[1]}, Coords{coords[0] + 1, coords[1]}};
-}
-
-bool processPoint(Map &scaledMap, const Coords &coords, size_t &count,
-                  std::queue<Coords> &seeds) {
-  bool add = false;
-  char &ch = scaledMap[coords[0]][coords[1]];
+void processPoint(ScaledMap &scaledMap, ptrdiff_t index, size_t &count,
+                  std::queue<ptrdiff_t> &seeds) {
+  char &ch = scaledMap[index];
   if (ch == ' ') {
     ch = '#';
-    seeds.push(coords);
+    seeds.push(index);
   } else if (ch == '.') {
     ++count;
     ch = '#';
-    seeds.push(coords);
+    seeds.push(index);
   }
-  return add;
 }
 
-size_t regionGrow(Map &scaledMap, const Coords &start) {
-  std::queue<Coords> seeds;
+size_t regionGrow(ScaledMap &scaledMap, const Coords &start) {
+  std::queue<ptrdiff_t> seeds;
   size_t count = 0;
-  const Coords scaledStart{2 * start[0], 2 * start[1]};
-  processPoint(scaledMap, scaledStart, count, seeds);
+  const auto neighbours = scaledMap.neighbours4();
+  processPoint(scaledMap, scaledMap.index(start * 2), count, seeds);
   while (!seeds.empty()) {
-    // std::cout << seeds.size() << "\n";
-    const Coords coords = seeds.front();
+    const ptrdiff_t index = seeds.front();
     seeds.pop();
     // Expand seed.
-    if (coords[0] > 0) {
-      processPoint(scaledMap, Coords{coords[0] - 1, coords[1]}, count, seeds);
-    }
-    if (coords[0] < scaledMap.size() - 1) {
-      processPoint(scaledMap, Coords{coords[0] + 1, coords[1]}, count, seeds);
-    }
-    if (coords[1] > 0) {
-      processPoint(scaledMap, Coords{coords[0], coords[1] - 1}, count, seeds);
-    }
-    if (coords[1] < scaledMap[0].size() - 1) {
-      processPoint(scaledMap, Coords{coords[0], coords[1] + 1}, count, seeds);
+    for (const ptrdiff_t offset : neighbours) {
+      processPoint(scaledMap, index + offset, count, seeds);
     }
   }
   return count;
 }
 
-size_t countDots(const Map &map) {
+size_t countDots(const ScaledMap &map) {
   size_t count = 0;
-  for (const auto &l : map) {
-    for (const char &ch : l) {
-      if (ch == '.') {
-        ++count;
-      }
-    }
+  for (int row = 0; row < map.rows(); ++row) {
+    count += std::count(map.row(row), map.row(row) + map.cols(), '.');
   }
   return count;
 }
 
-void printMap(const Map &map) {
-  for (const auto &l : map) {
-    std::cout << l << "\n";
-  }
-}
+void printMap(const ScaledMap &map) { std::cout << map; }
 
 void solvePart2() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  Map map;
-  parseMap(ifs, map);
+  const InputFile input(inputPath);
+  // const InputFile input("input_test.txt");
+  const Map map = Map::fromLines(input.lines(), '.');
   // Find start.
   const auto startCoords = findStartCoords(map); // row, col
   const auto startConnections = findStartConnections(map, startCoords);
-  Map scaledMap = makeScaledEmptyMap(map);
+  ScaledMap scaledMap = makeScaledEmptyMap(map);
   Coords cur = startCoords;
   Coords next = startConnections[0];
-  Coords nextNext;
   size_t pipeLength = 0;
   do {
-    scaledMap[2 * cur[0]][2 * cur[1]] = map[cur[0]][cur[1]];
-    scaledMap[cur[0] + next[0]][cur[1] + next[1]] = getConnector(cur, next);
-    nextNext = getNext(map, cur, next);
-    std::swap(cur, next);
-    std::swap(next, nextNext);
+    scaledMap[cur * 2] = map[cur];
+    scaledMap[cur + next] = getConnector(cur, next);
+    const Coords nextNext = getNext(map, cur, next);
+    cur = next;
+    next = nextNext;
     pipeLength += 2;
-  } while ((cur[0] != startCoords[0]) || (cur[1] != startCoords[1]));
+  } while (cur != startCoords);
   // Segment the area outside the loop. This is easier to identify than the inlying area.
   regionGrow(scaledMap, Coords{0, 0});
   //printMap(scaledMap);
@@ -239,7 +197,11 @@ void solvePart2() {
   std::cout << "Area: " << count << "\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
@@ -1,43 +1,180 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstddef>
 #include <iomanip>
 #include <iostream>
+#include <vector>
+#include "../common/batch.h"
+#include "../common/bench.h"
+#include "../common/embed.h"
+#include "../common/input.h"
+#include "../common/parse.h"
 
-inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
+// Use this in the solve.cpp:
+// using Coords = Coords_<int>;
+// or whatever type fits the puzzle best.
+template <typename T> struct Coords_ {
+  T row, col;
+  Coords_(T row_, T col_) : row(row_), col(col_) {}
+  Coords_<T> plus(T row_, T col_) const {
+    return Coords_<T>(row + row_, col + col_);
+  }
+  void plusEquals(T row_, T col_) {
+    row += row_;
+    col += col_;
+  }
+  Coords_<T> operator+(const Coords_<T> &rhs) const {
+    return Coords_<T>(row + rhs.row, col + rhs.col);
+  }
+  Coords_<T> operator-(const Coords_<T> &rhs) const {
+    return Coords_<T>(row - rhs.row, col - rhs.col);
+  }
+  Coords_<T> &operator+=(const Coords_<T> &rhs) {
+    row += rhs.row;
+    col += rhs.col;
+    return *this;
+  }
+  Coords_<T> &operator-=(const Coords_<T> &rhs) {
+    row -= rhs.row;
+    col -= rhs.col;
+    return *this;
+  }
+  Coords_<T> operator*(const T scale) const {
+    return Coords_<T>(row * scale, col * scale);
+  }
+  Coords_<T> &operator*=(const T scale) {
+    row *= scale;
+    col *= scale;
+    return *this;
+  }
+  T manhattanDistance() const { return std::abs(row) + std::abs(col); }
+
+  static Coords_<T> Up() { return Coords_<T>(-1, 0); }
+  static Coords_<T> Down() { return Coords_<T>(1, 0); }
+  static Coords_<T> Left() { return Coords_<T>(0, -1); }
+  static Coords_<T> Right() { return Coords_<T>(0, 1); }
+};
+
+template <typename T>
+inline bool operator==(const Coords_<T> &lhs, const Coords_<T> &rhs) {
+  return lhs.row == rhs.row && lhs.col == rhs.col;
+}
+
+template <typename T>
+inline bool operator!=(const Coords_<T> &lhs, const Coords_<T> &rhs) {
+  return !(lhs == rhs);
+}
+
+// Row-major 2D grid in a single allocation. The cells are surrounded by a
+// border of `padding` cells holding a sentinel value, so neighbours can be
+// accessed without bounds checks. Border cells have the (row, col) coordinates
+// -padding..-1 and rows()..rows()+padding-1 (cols() respectively).
+// Cells can be addressed by coordinates or by their flat index. Moving by an
+// offset() is a single addition on the flat index.
+template <typename T> class Grid {
+public:
+  Grid() = default;
+  Grid(int rows_, int cols_, const T &sentinel, int padding_ = 1)
+      : numRows(rows_), numCols(cols_), padding(padding_),
+        stride(cols_ + 2 * padding_),
+        cells(static_cast<size_t>(rows_ + 2 * padding_) * stride, sentinel) {}
+
+  // Copies the characters of text lines, e.g. of InputFile::lines(). All lines
+  // need to be as long as the first one.
+  template <typename Lines>
+  static Grid fromLines(const Lines &lines, const T &sentinel,
+                        int padding = 1) {
+    const int rows = static_cast<int>(lines.size());
+    const int cols = rows > 0 ? static_cast<int>(lines[0].size()) : 0;
+    Grid grid(rows, cols, sentinel, padding);
+    for (int row = 0; row < rows; ++row) {
+      T *dest = grid.row(row);
+      for (int col = 0; col < cols; ++col) {
+        dest[col] = static_cast<T>(lines[row][col]);
+      }
+    }
+    return grid;
+  }
+
+  int rows() const { return numRows; }
+  int cols() const { return numCols; }
+  ptrdiff_t rowStride() const { return stride; }
+  // Number of cells including the border, i.e. the end of the flat indices.
+  size_t size() const { return cells.size(); }
+
+  ptrdiff_t index(int row, int col) const {
+    return (row + padding) * stride + col + padding;
+  }
+  template <typename I> ptrdiff_t index(const Coords_<I> &coords) const {
+    return index(static_cast<int>(coords.row), static_cast<int>(coords.col));
+  }
+  template <typename I = int> Coords_<I> coords(ptrdiff_t index) const {
+    return Coords_<I>(static_cast<I>(index / stride - padding),
+                      static_cast<I>(index % stride - padding));
+  }
+
+  // Difference of the flat indices of two cells dRow rows and dCol columns
+  // apart.
+  ptrdiff_t offset(int dRow, int dCol) const { return dRow * stride + dCol; }
+  template <typename I> ptrdiff_t offset(const Coords_<I> &dir) const {
+    return offset(static_cast<int>(dir.row), static_cast<int>(dir.col));
+  }
+
+  // Up, down, left, right.
+  std::array<ptrdiff_t, 4> neighbours4() const {
+    return {-stride, stride, -1, 1};
+  }
+  // Including the diagonals, row by row.
+  std::array<ptrdiff_t, 8> neighbours8() const {
+    return {-stride - 1, -stride, -stride + 1, -1,
+            1,           stride - 1, stride,   stride + 1};
+  }
+
+  bool contains(int row, int col) const {
+    return row >= 0 && row < numRows && col >= 0 && col < numCols;
+  }
+  template <typename I> bool contains(const Coords_<I> &coords) const {
+    return contains(static_cast<int>(coords.row), static_cast<int>(coords.col));
+  }
 
-template <typename Func>
-void measureTime(Func func, const std::string &name, int repetitions = 1) {
-  std::cout << "Running " << name << "...\n";
-  const auto start = std::chrono::steady_clock::now();
-  for (int i = 0; i < repetitions; ++i) {
-    func();
-  }
-  const auto end = std::chrono::steady_clock::now();
-  const auto diff = end - start;
-  // Print duration in readable form.
-  std::cout << name << " took ";
-  if (std::chrono::duration_cast<std::chrono::milliseconds>(diff).count() /
-          static_cast<double>(repetitions) >=
-      10000.0) {
-    const auto s =
-        (std::chrono::duration_cast<std::chrono::milliseconds>(diff).count() /
-         static_cast<double>(repetitions)) /
-        1000.0;
-    std::cout << std::setprecision(6) << s << " s\n";
-  }
-  if (std::chrono::duration_cast<std::chrono::milliseconds>(diff).count() /
-          static_cast<double>(repetitions) <
-      10.0) {
-    const auto ms =
-        (std::chrono::duration_cast<std::chrono::microseconds>(diff).count() /
-         static_cast<double>(repetitions)) /
-        1000.0;
-    std::cout << std::setprecision(6) << ms << " ms\n";
-
-  } else {
-    std::cout << std::setprecision(6)
-              << (std::chrono::duration_cast<std::chrono::milliseconds>(diff)
-                      .count() /
-                  static_cast<double>(repetitions))
-              << " ms\n";
+  T &operator[](ptrdiff_t index) { return cells[index]; }
+  const T &operator[](ptrdiff_t index) const { return cells[index]; }
+  template <typename I> T &operator[](const Coords_<I> &coords) {
+    return cells[index(coords)];
   }
+  template <typename I> const T &operator[](const Coords_<I> &coords) const {
+    return cells[index(coords)];
+  }
+  T &operator()(int row, int col) { return cells[index(row, col)]; }
+  const T &operator()(int row, int col) const {
+    return cells[index(row, col)];
+  }
+
+  // First cell of a row, the border is in front of it.
+  T *row(int row) { return &cells[index(row, 0)]; }
+  const T *row(int row) const { return &cells[index(row, 0)]; }
+
+  // Sets all cells except for the border.
+  void fill(const T &value) {
+    for (int r = 0; r < numRows; ++r) {
+      std::fill(row(r), row(r) + numCols, value);
+    }
+  }
+
+private:
+  int numRows = 0;
+  int numCols = 0;
+  int padding = 0;
+  ptrdiff_t stride = 0;
+  std::vector<T> cells;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const Grid<char> &grid) {
+  for (int row = 0; row < grid.rows(); ++row) {
+    os.write(grid.row(row), grid.cols()) << "\n";
+  }
+  return os;
 }
+
+inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
@@ -1,20 +1,22 @@
 #include "utils.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using num = long long;
-using Coords = std::array<num, 2>; // Row, col
+using Coords = Coords_<num>;
+// Galaxies are only looked at within the image, so no border is needed.
+using Image = Grid<char>;
 
-std::vector<num> buildRowMap(const std::vector<std::string> &lines,
-                             num expansion) {
-  std::vector<num> rowMap;
-  rowMap.reserve(lines.size());
+std::vector<num> buildRowMap(const Image &image, num expansion) {
+  std::vector<num> rowMap(image.rows());
   num offset = 0;
-  for (size_t row = 0; row < lines.size(); ++row) {
-    const auto &line = lines[row];
-    if (line.find('#') == std::string::npos) {
+  for (int row = 0; row < image.rows(); ++row) {
+    const char *line = image.row(row);
+    if (std::find(line, line + image.cols(), '#') == line + image.cols()) {
       // Empty
       offset += expansion - 1;
     }
@@ -23,18 +25,17 @@ std::vector<num> buildRowMap(const std::vector<std::string> &lines,
   return rowMap;
 }
 
-std::vector<num> buildColMap(const std::vector<std::string> &lines,
-                             num expansion) {
-  std::vector<num> colMap;
-  colMap.reserve(lines[0].size());
-  size_t offset = 0;
-  for (size_t col = 0; col < lines[0].size(); ++col) {
+std::vector<num> buildColMap(const Image &image, num expansion) {
+  std::vector<num> colMap(image.cols());
+  // Walk down the columns by stepping one row stride at a time.
+  const ptrdiff_t down = image.offset(Coords::Down());
+  const ptrdiff_t end = image.index(image.rows(), 0);
+  num offset = 0;
+  for (int col = 0; col < image.cols(); ++col) {
     bool foundGalaxy = false;
-    for (size_t row = 0; row < lines.size(); ++row) {
-      const auto &line = lines[row];
-      if (line[col] == '#') {
-        foundGalaxy = true;
-      }
+    for (ptrdiff_t i = image.index(0, col); i < end && !foundGalaxy;
+         i += down) {
+      foundGalaxy = (image[i] == '#');
     }
     if (!foundGalaxy) {
       // Empty
@@ -45,13 +46,13 @@ std::vector<num> buildColMap(const std::vector<std::string> &lines,
   return colMap;
 }
 
-std::vector<Coords> extractGalaxyCoords(const std::vector<std::string> &lines) {
+std::vector<Coords> extractGalaxyCoords(const Image &image) {
   std::vector<Coords> coords;
-  for (size_t row = 0; row < lines.size(); ++row) {
-    const auto &line = lines[row];
-    for (size_t col = 0; col < line.size(); ++col) {
+  for (int row = 0; row < image.rows(); ++row) {
+    const char *line = image.row(row);
+    for (int col = 0; col < image.cols(); ++col) {
       if (line[col] == '#') {
-        coords.push_back({static_cast<num>(row), static_cast<num>(col)});
+        coords.emplace_back(row, col);
       }
     }
   }
@@ -62,8 +63,8 @@ void expandGalaxyCoords(std::vector<Coords> &coords,
                         const std::vector<num> &rowMap,
                         const std::vector<num> &colMap) {
   for (auto &c : coords) {
-    c[0] = rowMap[c[0]];
-    c[1] = colMap[c[1]];
+    c.row = rowMap[c.row];
+    c.col = colMap[c.col];
   }
 }
 
@@ -74,7 +75,7 @@ size_t computePairwiseDistances(const std::vector<Coords> &coords) {
       const auto &src = coords[i];
       const auto &dest = coords[j];
       // Manhattan distance
-      const auto dist = std::abs(dest[0] - src[0]) + std::abs(dest[1] - src[1]);
+      const auto dist = (dest - src).manhattanDistance();
       sum += dist;
     }
   }
@@ -82,27 +83,27 @@ size_t computePairwiseDistances(const std::vector<Coords> &coords) {
 }
 
 void solveBothParts() {
-  std::ifstream ifs("input.txt");
-  //std::ifstream ifs("input_test.txt");
-  std::string line;
-  std::vector<std::string> lines;
-  while (std::getline(ifs, line)) {
-    lines.push_back(line);
-  }
+  const InputFile input(inputPath);
+  //const InputFile input("input_test.txt");
+  const auto image = Image::fromLines(input.lines(), '.', 0);
   const std::vector<num> expansions{2, 1'000'000};
-  auto ogCoords = extractGalaxyCoords(lines);
+  auto ogCoords = extractGalaxyCoords(image);
   for (num i : expansions) {
     auto coords = ogCoords;
     // These lookup tables map text coordinates -> expanded coordinates.
-    auto rowMap = buildRowMap(lines, i);
-    auto colMap = buildColMap(lines, i);
+    auto rowMap = buildRowMap(image, i);
+    auto colMap = buildColMap(image, i);
     expandGalaxyCoords(coords, rowMap, colMap);
     const auto sum = computePairwiseDistances(coords);
     std::cout << "Expansion " << i << ": " << sum << "\n";
   }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Both parts", &solveBothParts}});
+  }
   measureTime(&solveBothParts, "Both parts");
   std::cout << "Done.\n";
   return 0;
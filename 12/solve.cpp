@@ -2,23 +2,68 @@
 #include <algorithm>
 #include <cassert>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-struct Processor {
-  size_t processLine(const std::string &line, unsigned short startLine,
-                     unsigned char brokenCount, const std::vector<int> &broken,
+using Query = unsigned long long;
+// Sizes of the blocks of broken springs.
+using Blocks = std::pmr::vector<int>;
+
+using FlatMemo = FlatHashMap<Query, size_t, FlatHash<Query>, std::equal_to<>,
+                             std::pmr::polymorphic_allocator<char>>;
+
+// The memo before FlatMemo with the same interface, the reference for the
+// runner's --compare.
+class StdMemo {
+public:
+  explicit StdMemo(std::pmr::memory_resource *resource) : map(resource) {}
+
+  void reserve(size_t n) { map.reserve(n); }
+  std::pair<size_t *, bool> tryEmplace(Query query) {
+    const auto [it, inserted] = map.try_emplace(query);
+    return {&it->second, inserted};
+  }
+  size_t *find(Query query) {
+    const auto it = map.find(query);
+    return it != map.end() ? &it->second : nullptr;
+  }
+  // The nodes never move, see Processor::store().
+  size_t capacity() const { return 0; }
+
+private:
+  std::pmr::unordered_map<Query, size_t> map;
+};
+
+template <typename Memo> struct Processor {
+  // Most lines need fewer entries than expectedEntries, so the memo rarely
+  // grows.
+  Processor(std::pmr::memory_resource *resource, size_t expectedEntries)
+      : memory(resource) {
+    memory.reserve(expectedEntries);
+  }
+
+  size_t processLine(std::string_view line, unsigned short startLine,
+                     unsigned char brokenCount, const Blocks &broken,
                      unsigned char startBroken) {
     size_t newSolutions = 0;
-    // Use memoization to avoid redundant computations.
+    // Use memoization to avoid redundant computations. The entry is added
+    // right away and filled in when the branch is done, so a single probe
+    // both looks it up and inserts it. The branches explored below start
+    // further right, so they never look up this entry while it is unfilled.
     const auto query = makeQuery(startLine, brokenCount, startBroken);
-    auto queryMatch = memory.find(query);
-    if (queryMatch != memory.end()) {
-      return queryMatch->second;
+    const auto [known, inserted] = memory.tryEmplace(query);
+    if (!inserted) {
+      return *known;
     }
+    size_t *const entry = known;
+    const size_t capacity = memory.capacity();
+    const auto remember = [&](size_t solutions) {
+      return store(query, entry, capacity, solutions);
+    };
     // The branch has not yet been computed -> explore it.
     for (size_t i = startLine; i < line.size(); ++i) {
       const char ch = line[i];
@@ -31,26 +76,22 @@ struct Processor {
               brokenCount = 0;
             } else {
               // Detected inconsistency.
-              memory[query] = newSolutions;
-              return newSolutions;
+              return remember(newSolutions);
             }
           } else {
             // Detected inconsistency.
-            memory[query] = newSolutions;
-            return newSolutions;
+            return remember(newSolutions);
           }
         }
       } else if (ch == '#') {
         if (startBroken == broken.size()) {
           // Detected inconsistency.
-          memory[query] = newSolutions;
-          return newSolutions;
+          return remember(newSolutions);
         }
         ++brokenCount;
         if (brokenCount > broken[startBroken]) {
           // Detected inconsistency.
-          memory[query] = newSolutions;
-          return newSolutions;
+          return remember(newSolutions);
         }
       } else if (ch == '?') {
         {
@@ -70,16 +111,13 @@ struct Processor {
               brokenCount = 0;
             } else if (brokenCount != 0) {
               // Detected inconsistency.
-              memory[query] = newSolutions;
-              return newSolutions;
+              return remember(newSolutions);
             }
           }
           newSolutions += processLine(line, i + 1, 0, broken, startBroken);
-          memory[query] = newSolutions;
-          return newSolutions;
+          return remember(newSolutions);
         }
-        memory[query] = newSolutions;
-        return newSolutions;
+        return remember(newSolutions);
       }
     }
     // Reached end of the line.
@@ -89,13 +127,21 @@ struct Processor {
              broken.size() - 1)) { // Finishing last block on line ending.
       ++newSolutions;
     }
-    memory[query] = newSolutions;
-    return newSolutions;
+    return remember(newSolutions);
   }
 
 private:
-  using Query = unsigned long long;
-  std::unordered_map<Query, size_t> memory;
+  // Stores the solutions in the entry added for query, which has moved if
+  // the memo grew in between.
+  size_t store(Query query, size_t *entry, size_t capacity, size_t solutions) {
+    if (memory.capacity() != capacity) {
+      entry = memory.find(query);
+    }
+    *entry = solutions;
+    return solutions;
+  }
+
+  Memo memory;
 
   Query makeQuery(unsigned short startLine, unsigned short brokenCount,
                   unsigned short startBroken) {
@@ -111,64 +157,114 @@ private:
   }
 };
 
-size_t processLine(const std::string &line, const std::vector<int> &broken) {
-  return Processor().processLine(line, 0, 0, broken, 0);
+// The caller rewinds the arena after the line.
+template <typename Memo>
+size_t processLine(std::string_view line, const Blocks &broken) {
+  // The memo holds about line.size() * broken.size() / 2 entries, rarely more
+  // than twice that.
+  const size_t expectedEntries = line.size() * (broken.size() + 1);
+  return Processor<Memo>(&scratchArena(), expectedEntries)
+      .processLine(line, 0, 0, broken, 0);
 }
 
-std::vector<int> parseBroken(std::string &brokenStr) {
-  std::replace(brokenStr.begin(), brokenStr.end(), ',', ' ');
-  std::istringstream iss(brokenStr);
-  std::vector<int> ret;
-  while (!iss.eof()) {
-    int num;
-    iss >> num;
+Blocks parseBroken(std::string_view brokenStr) {
+  Parser parser(brokenStr);
+  Blocks ret(&scratchArena());
+  int num;
+  while (parser.tryNextInt(num)) {
     ret.push_back(num);
   }
   return ret;
 }
 
-void solvePart1() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string line;
+// The lines may run on any thread of the pool, so they take the arena of
+// the current thread for the blocks and the memo, and rewind it when done.
+template <typename Memo> size_t arrangements1(std::string_view line) {
+  const ArenaScope scope;
+  Parser parser(line);
+  const auto map = parser.nextWord();
+  const auto brokenStr = parser.nextWord();
+  auto broken = parseBroken(brokenStr);
+  return processLine<Memo>(map, broken);
+}
+
+template <typename Memo> size_t arrangements2(std::string_view line) {
+  const ArenaScope scope;
+  Parser parser(line);
+  const auto map = parser.nextWord();
+  const auto brokenStr = parser.nextWord();
+  const auto brokenFolded = parseBroken(brokenStr);
+  std::pmr::string mapUnfolded(&scratchArena());
+  mapUnfolded.reserve(map.size() * 5 + 4);
+  mapUnfolded.append(map);
+  Blocks broken(&scratchArena());
+  broken.reserve(brokenFolded.size() * 5);
+  broken.assign(brokenFolded.begin(), brokenFolded.end());
+  for (int copy = 1; copy < 5; ++copy) {
+    mapUnfolded.append("?").append(map);
+    broken.insert(broken.end(), brokenFolded.begin(), brokenFolded.end());
+  }
+  return processLine<Memo>(mapUnfolded, broken);
+}
+
+// Sum over the lines of a batch. The lines are independent.
+template <typename Func>
+size_t sumOverBatch(const std::vector<std::string_view> &lines, Func func) {
+  return parallelReduce(
+      0, lines.size(), size_t(0), [&](size_t i) { return func(lines[i]); },
+      std::plus<>());
+}
+
+// The lines are streamed in batches (see LineReader), so the input may be of
+// any size.
+template <typename Memo = FlatMemo> void solvePart1() {
+  LineReader reader(inputPath);
+  // LineReader reader("input_test.txt");
+  std::vector<std::string_view> lines;
   size_t sum = 0;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    std::string map, brokenStr;
-    iss >> map >> brokenStr;
-    auto broken = parseBroken(brokenStr);
-    auto count = processLine(map, broken);
-    // std::cout << line << " --> " << count << "\n";
-    sum += count;
+  while (reader.nextBatch(lines)) {
+    sum += sumOverBatch(lines, &arrangements1<Memo>);
   }
   std::cout << "Sum: " << sum << "\n";
 }
 
-void solvePart2() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string line;
+template <typename Memo = FlatMemo> void solvePart2() {
+  LineReader reader(inputPath);
+  // LineReader reader("input_test.txt");
+  std::vector<std::string_view> lines;
   size_t sum = 0;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    std::string map, brokenStr;
-    iss >> map >> brokenStr;
-    std::string mapUnfolded = map, brokenStrUnfolded = brokenStr;
-    for (int i = 1; i < 5; ++i) {
-      mapUnfolded = mapUnfolded + "?" + map;
-      brokenStrUnfolded = brokenStrUnfolded + "," + brokenStr;
-    }
-    auto broken = parseBroken(brokenStrUnfolded);
-    auto count = processLine(mapUnfolded, broken);
-    //std::cout << line << " --> " << count << "\n";
-    sum += count;
+  while (reader.nextBatch(lines)) {
+    sum += sumOverBatch(lines, &arrangements2<Memo>);
   }
   std::cout << "Sum: " << sum << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  std::vector<std::string_view> lines;
+  size_t sum1 = 0;
+  size_t sum2 = 0;
+  while (reader.nextBatch(lines)) {
+    sum1 += sumOverBatch(lines, &arrangements1<FlatMemo>);
+    sum2 += sumOverBatch(lines, &arrangements2<FlatMemo>);
+  }
+  std::cout << "Sum: " << sum1 << "\n";
+  std::cout << "Sum: " << sum2 << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1<>}, {"Part 2", &solvePart2<>}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1<>, "Part 1");
+    measureTime(&solvePart2<>, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
@@ -1,46 +1,40 @@
 #include "utils.h"
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
-using Pattern = std::vector<std::string>;
+// The reflection checks stay within the pattern, so no border is needed.
+using Pattern = Grid<char>;
 using Patterns = std::vector<Pattern>;
 
-std::ostream &operator<<(std::ostream &os, const Pattern &pattern) {
-  for (const auto &line : pattern) {
-    os << line << "\n";
-  }
-  return os;
-}
-
-Patterns parsePatterns(std::ifstream &ifs) {
+Patterns parsePatterns(const std::vector<std::string_view> &lines) {
   Patterns patterns;
-  std::string line;
-  patterns.emplace_back();
-  Pattern *curPattern = &patterns.back();
-  while (std::getline(ifs, line)) {
-    if (line.empty()) {
-      patterns.emplace_back();
-      curPattern = &patterns.back();
-    } else {
-      curPattern->push_back(line);
-    }
+  auto first = lines.begin();
+  while (first != lines.end()) {
+    const auto last = std::find_if(first, lines.end(),
+                                   [](std::string_view l) { return l.empty(); });
+    patterns.push_back(Pattern::fromLines(
+        std::vector<std::string_view>(first, last), '.', 0));
+    first = (last == lines.end()) ? last : last + 1;
   }
   return patterns;
 }
 
 int findVerticalReflection(const Pattern &pattern, int smudges = 0) {
-  const size_t rows = pattern.size();
-  const size_t cols = pattern[0].size();
+  const size_t rows = pattern.rows();
+  const size_t cols = pattern.cols();
   // Check for reflections between column colLeft and colRight.
   for (size_t colLeft = 0; colLeft < cols - 1; ++colLeft) {
     const size_t colRight = colLeft + 1;
     int smudgesLeft = smudges;
     bool consistent = true;
     for (size_t row = 0; row < rows && consistent; ++row) {
-      const auto &line = pattern[row];
+      const char *line = pattern.row(row);
       const size_t maxOffset = std::min(cols - colRight - 1, colLeft);
       for (size_t colOffset = 0; colOffset <= maxOffset && consistent;
            ++colOffset) {
@@ -61,8 +55,8 @@ int findVerticalReflection(const Pattern &pattern, int smudges = 0) {
 }
 
 int findHorizontalReflection(const Pattern &pattern, int smudges = 0) {
-  const size_t rows = pattern.size();
-  const size_t cols = pattern[0].size();
+  const size_t rows = pattern.rows();
+  const size_t cols = pattern.cols();
   // Check for reflections between rows rowTop and rowBot.
   for (size_t rowTop = 0; rowTop < rows - 1; ++rowTop) {
     const size_t rowBot = rowTop + 1;
@@ -72,8 +66,8 @@ int findHorizontalReflection(const Pattern &pattern, int smudges = 0) {
       const size_t maxOffset = std::min(rows - rowBot - 1, rowTop);
       for (size_t rowOffset = 0; rowOffset <= maxOffset && consistent;
            ++rowOffset) {
-        const auto &lineTop = pattern[rowTop - rowOffset];
-        const auto &lineBot = pattern[rowBot + rowOffset];
+        const char *lineTop = pattern.row(rowTop - rowOffset);
+        const char *lineBot = pattern.row(rowBot + rowOffset);
         if (lineTop[col] != lineBot[col]) {
           --smudgesLeft;
           if (smudgesLeft < 0) {
@@ -91,37 +85,42 @@ int findHorizontalReflection(const Pattern &pattern, int smudges = 0) {
 }
 
 void solve(const Patterns &patterns, int smudges) {
-  size_t sum = 0;
-  for (const auto &pattern : patterns) {
-    // std::cout << pattern;
-    const auto verticalReflection = findVerticalReflection(pattern, smudges);
-    if (verticalReflection >= 0) {
-      // std::cout << "Vertical: " << verticalReflection << "\n\n";
-      sum += verticalReflection + 1;
-    } else {
-      const auto horizontalReflection =
-          findHorizontalReflection(pattern, smudges);
-      // std::cout << "Horizontal: " << horizontalReflection << "\n\n";
-      sum += 100 * (horizontalReflection + 1);
-      // Sanity check
-      if (horizontalReflection < 0) {
-        throw std::runtime_error(
-            "Found no reflection at all for this pattern!");
-      }
-    }
-  }
+  // The patterns are independent.
+  const size_t sum = parallelReduce(
+      0, patterns.size(), size_t(0),
+      [&](size_t i) -> size_t {
+        const auto &pattern = patterns[i];
+        const auto verticalReflection =
+            findVerticalReflection(pattern, smudges);
+        if (verticalReflection >= 0) {
+          return verticalReflection + 1;
+        }
+        const auto horizontalReflection =
+            findHorizontalReflection(pattern, smudges);
+        // Sanity check
+        if (horizontalReflection < 0) {
+          throw std::runtime_error(
+              "Found no reflection at all for this pattern!");
+        }
+        return 100 * (horizontalReflection + 1);
+      },
+      std::plus<>());
   std::cout << smudges << " smudges: "
             << " sum: " << sum << "\n";
 }
 
 void solveBothParts() {
-  std::ifstream ifs("input.txt");
-  const auto patterns = parsePatterns(ifs);
+  const InputFile input(inputPath);
+  const auto patterns = parsePatterns(input.lines());
   solve(patterns, 0); // Part 1
   solve(patterns, 1); // Part 2
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Both parts", &solveBothParts}});
+  }
   measureTime(&solveBothParts, "Both parts");
   std::cout << "Done.\n";
   return 0;
@@ -6,55 +6,44 @@
 #include <string>
 #include <vector>
 
-std::vector<std::string> parseField(std::ifstream &ifs) {
-  std::string line;
-  std::vector<std::string> field;
-  while (std::getline(ifs, line)) {
-    field.push_back(line);
-  }
-  return field;
-}
+// The border is made of cube rocks ('#'), so the rolling stops there without
+// any bounds checks.
+using Field = Grid<char>;
 
-template <int dir> size_t rollVertical(std::vector<std::string> &field) {
+template <int dir> size_t rollVertical(Field &field) {
   size_t totalLoad = 0;
-  const int rows = static_cast<int>(field.size());
-  const int cols = static_cast<int>(field[0].size());
+  const int rows = field.rows();
+  const int cols = field.cols();
   const int rowStart = (dir < 0) ? 0 : rows - 1;
   auto checkRowInBounds = [rows](int row) {
     return (dir < 0) ? (row < rows) : (row >= 0);
   };
   constexpr int rowInc = (dir < 0) ? 1 : -1;
+  const ptrdiff_t step = field.offset(dir, 0);
   for (int row = rowStart; checkRowInBounds(row); row += rowInc) {
-    auto &line = field[row];
     for (int col = 0; col < cols; ++col) {
-      if (line[col] == 'O') {
-        int maxAllowedDist = 0;
-        for (int dist = dir;
-             (dist < 0 && dist >= -row) || (dist > 0 && dist < (rows - row));
-             dist += dir) {
-          if (field[row + dist][col] == '.') {
-            maxAllowedDist = dist;
-          } else {
-            break;
-          }
+      const ptrdiff_t index = field.index(row, col);
+      if (field[index] == 'O') {
+        ptrdiff_t dest = index;
+        while (field[dest + step] == '.') {
+          dest += step;
         }
-        const int destRow = row + maxAllowedDist;
-        if (maxAllowedDist != 0) {
+        if (dest != index) {
           // Move the round rock.
-          line[col] = '.';
-          field[row + maxAllowedDist][col] = 'O';
+          field[index] = '.';
+          field[dest] = 'O';
         }
-        totalLoad += rows - destRow;
+        totalLoad += rows - field.coords(dest).row;
       }
     }
   }
   return totalLoad;
 }
 
-template <int dir> size_t rollHorizontal(std::vector<std::string> &field) {
+template <int dir> size_t rollHorizontal(Field &field) {
   size_t totalLoad = 0;
-  const int rows = static_cast<int>(field.size());
-  const int cols = static_cast<int>(field[0].size());
+  const int rows = field.rows();
+  const int cols = field.cols();
   const int colStart = (dir < 0) ? 0 : cols - 1;
   auto checkColInBounds = [cols](int col) {
     return (dir < 0) ? (col < cols) : (col >= 0);
@@ -62,23 +51,16 @@ template <int dir> size_t rollHorizontal(std::vector<std::string> &field) {
   constexpr int colInc = (dir < 0) ? 1 : -1;
   for (int col = colStart; checkColInBounds(col); col += colInc) {
     for (int row = 0; row < rows; ++row) {
-      auto &line = field[row];
+      char *line = field.row(row);
       if (line[col] == 'O') {
-        int maxAllowedDist = 0;
-        for (int dist = dir;
-             (dist < 0 && dist >= -col) || (dist > 0 && dist < (cols - col));
-             dist += dir) {
-          if (field[row][col + dist] == '.') {
-            maxAllowedDist = dist;
-          } else {
-            break;
-          }
+        int dest = col;
+        while (line[dest + dir] == '.') {
+          dest += dir;
         }
-        const int destCol = col + maxAllowedDist;
-        if (maxAllowedDist != 0) {
+        if (dest != col) {
           // Move the round rock.
           line[col] = '.';
-          line[col + maxAllowedDist] = 'O';
+          line[dest] = 'O';
         }
         totalLoad += rows - row;
       }
@@ -88,11 +70,10 @@ template <int dir> size_t rollHorizontal(std::vector<std::string> &field) {
 }
 
 void solvePart1() {
-  std::ifstream ifs("input.txt");
-  auto field = parseField(ifs);
+  const InputFile input(inputPath);
+  auto field = Field::fromLines(input.lines(), '#');
   const auto totalLoad = rollVertical<-1>(field);
   // std::cout << field;
-  assert(totalLoad == 109654);
   std::cout << "Total load: " << totalLoad << "\n";
 }
 
@@ -106,11 +87,10 @@ template <size_t size> inline bool allEqual(const std::array<size_t, size> &a) {
 }
 
 void solvePart2() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  auto field = parseField(ifs);
+  const InputFile input(inputPath);
+  // const InputFile input("input_test.txt");
+  auto field = Field::fromLines(input.lines(), '#');
   size_t totalLoad = 0;
-  size_t lastInsertIndex = 0;
   for (size_t i = 0; i < 12498; ++i) {
     rollVertical<-1>(field);
     rollHorizontal<-1>(field);
@@ -130,7 +110,11 @@ void solvePart2() {
   std::cout << "Final total load: " << 94876 << "\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
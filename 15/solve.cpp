@@ -1,65 +1,76 @@
 #include "utils.h"
 #include <algorithm>
-#include <cassert>
+#include <array>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <list>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-inline unsigned char hash(const std::string &s) {
+constexpr unsigned char hash(std::string_view s) {
   unsigned char value = 0;
   for (size_t i = 0; i < s.size(); ++i) {
     // std::cout << s[i] << ": (" << static_cast<int>(value) << " + " <<
     // static_cast<int>(s[i]) << ") * 17";
-    value = (static_cast<int>(value) + s[i]) * 17;
+    value = static_cast<unsigned char>((value + s[i]) * 17);
     // std::cout << " = " << static_cast<int>(value) << "\n";
   }
   return value;
 }
 
-std::vector<std::string> parseCSV(std::ifstream &ifs) {
-  std::vector<std::string> ret;
-  std::string line;
-  std::getline(ifs, line);
-  std::stringstream iss(line);
-  std::string token;
-  while (std::getline(iss, token, ',')) {
-    ret.push_back(token);
+static_assert(hash("HASH") == 52);
+static_assert(hash("rn") == 0);
+static_assert(hash("qp") == 1);
+
+// The sequence ends with the line.
+constexpr std::string_view trimStep(std::string_view step) {
+  while (!step.empty() && (step.back() == '\n' || step.back() == '\r')) {
+    step.remove_suffix(1);
   }
-  return ret;
+  return step;
 }
 
-void solvePart1() {
-  // std::ifstream ifs("input_test.txt");
-  std::ifstream ifs("input.txt");
-  const auto strs = parseCSV(ifs);
-  long long sum = 0;
-  for (const auto &s : strs) {
-    auto h = hash(s);
-    // std::cout << s << ": " << static_cast<int>(h) << "\n";
-    sum += h;
-  }
-  std::cout << "Sum: " << sum << "\n";
+// Steps of a whole input, for the embedded build (see common/embed.h).
+template <typename Func>
+constexpr void forEachStepOf(std::string_view input, Func func) {
+  forEachRecord(input, ',', [&](std::string_view step) {
+    step = trimStep(step);
+    if (!step.empty()) {
+      func(step);
+    }
+  });
+}
+
+// Calls func for each step of the comma separated sequence. The steps are
+// streamed (see LineReader), so the sequence may be of any length.
+template <typename Func> void forEachStep(Func func) {
+  // LineReader reader("input_test.txt", ',');
+  LineReader reader(inputPath, ',');
+  reader.forEach([&](std::string_view step) {
+    step = trimStep(step);
+    if (!step.empty()) {
+      func(step);
+    }
+  });
 }
 
 struct Lens {
   std::string label;
   unsigned short int focalLength;
 
-  Lens(const std::string &label_, unsigned char focalLength_)
+  Lens(std::string_view label_, unsigned char focalLength_)
       : label(label_), focalLength(focalLength_) {}
 };
 
-bool operator==(const Lens &lhs, const std::string &rhs) {
+bool operator==(const Lens &lhs, std::string_view rhs) {
   return lhs.label == rhs;
 }
 
 class HashMap {
 public:
-  void insert(const std::string &label, unsigned char focalLength) {
+  void insert(std::string_view label, unsigned char focalLength) {
     const auto h = hash(label);
     auto &box = boxes[h];
     for (auto &l : box) {
@@ -72,7 +83,7 @@ public:
     box.emplace_back(label, focalLength);
   }
 
-  void remove(const std::string &label) {
+  void remove(std::string_view label) {
     const auto h = hash(label);
     auto &box = boxes[h];
     // If the box gets large and we remove often, this may be slow.
@@ -97,36 +108,125 @@ private:
   std::array<Box, 256> boxes;
 };
 
-void solvePart2() {
-  // std::ifstream ifs("input_test.txt");
-  std::ifstream ifs("input.txt");
-  const auto strs = parseCSV(ifs);
-  HashMap hashMap;
-  std::string label;
-  for (const auto &s : strs) {
-    // std::cout << s << "\n";
-    char lastCh = s.back();
-    if (lastCh == '-') {
-      // - operator
-      label = s.substr(0, s.size() - 1);
-      hashMap.remove(label);
+void applyStep(std::string_view s, HashMap &hashMap) {
+  // std::cout << s << "\n";
+  char lastCh = s.back();
+  if (lastCh == '-') {
+    // - operator
+    hashMap.remove(s.substr(0, s.size() - 1));
+  } else {
+    // = operator
+    const unsigned short focalLength = lastCh - '0';
+    hashMap.insert(s.substr(0, s.size() - 2), focalLength);
+  }
+  // std::cout << s << ": " << static_cast<int>(h) << "\n";
+}
+
+// HashMap with boxes of fixed capacity, so that part 2 can be evaluated at
+// compile time. Too many lenses in a box fail the build.
+constexpr size_t focusingPowerOf(std::string_view input) {
+  struct FixedLens {
+    std::string_view label;
+    unsigned char focalLength = 0;
+  };
+  struct FixedBox {
+    std::array<FixedLens, 32> lenses{};
+    size_t size = 0;
+  };
+  std::array<FixedBox, 256> boxes{};
+  forEachStepOf(input, [&](std::string_view s) {
+    const bool remove = s.back() == '-';
+    const auto label = s.substr(0, s.size() - (remove ? 1 : 2));
+    const auto focalLength = static_cast<unsigned char>(s.back() - '0');
+    auto &box = boxes[hash(label)];
+    size_t i = 0;
+    while (i < box.size && box.lenses[i].label != label) {
+      ++i;
+    }
+    if (remove) {
+      if (i < box.size) {
+        for (; i + 1 < box.size; ++i) {
+          box.lenses[i] = box.lenses[i + 1];
+        }
+        --box.size;
+      }
+    } else if (i < box.size) {
+      box.lenses[i].focalLength = focalLength;
+    } else if (box.size < box.lenses.size()) {
+      box.lenses[box.size++] = FixedLens{label, focalLength};
     } else {
-      // = operator
-      label = s.substr(0, s.size() - 2);
-      const unsigned short focalLength = lastCh - '0';
-      hashMap.insert(label, focalLength);
+      throw std::length_error("Too many lenses in a box.");
+    }
+  });
+  size_t ret = 0;
+  for (size_t iBox = 0; iBox < boxes.size(); ++iBox) {
+    for (size_t iLens = 0; iLens < boxes[iBox].size; ++iLens) {
+      ret += (iBox + 1) * (iLens + 1) * boxes[iBox].lenses[iLens].focalLength;
     }
-    // std::cout << s << ": " << static_cast<int>(h) << "\n";
   }
+  return ret;
+}
+
+#ifdef AOC_EMBED_INPUT
+// The answers are computed by the compiler, see common/embed.h.
+constexpr long long sumOfHashes(std::string_view input) {
+  long long sum = 0;
+  forEachStepOf(input, [&](std::string_view s) { sum += hash(s); });
+  return sum;
+}
+
+void solvePart1() {
+  constexpr long long sum = sumOfHashes(embeddedInput);
+  std::cout << "Sum: " << sum << "\n";
+}
+
+void solvePart2() {
+  constexpr size_t power = focusingPowerOf(embeddedInput);
+  std::cout << "Focusing power: " << power << "\n";
+}
+#else
+void solvePart1() {
+  long long sum = 0;
+  forEachStep([&](std::string_view s) {
+    auto h = hash(s);
+    // std::cout << s << ": " << static_cast<int>(h) << "\n";
+    sum += h;
+  });
+  std::cout << "Sum: " << sum << "\n";
+}
+
+// Only the lenses in the boxes are kept, not the steps.
+void solvePart2() {
+  HashMap hashMap;
+  forEachStep([&](std::string_view s) { applyStep(s, hashMap); });
   std::cout << "Focusing power: " << hashMap.focusingPower() << "\n";
 }
+#endif
 
-int main() {
-  assert(hash("HASH") == 52);
-  assert(hash("rn") == 0);
-  assert(hash("qp") == 1);
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  long long sum = 0;
+  HashMap hashMap;
+  forEachStep([&](std::string_view s) {
+    sum += hash(s);
+    applyStep(s, hashMap);
+  });
+  std::cout << "Sum: " << sum << "\n";
+  std::cout << "Focusing power: " << hashMap.focusingPower() << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
 }
@@ -1,8 +1,15 @@
 #include "utils.h"
 #include <fstream>
 #include <iostream>
+#include <memory_resource>
 #include <queue>
 #include <string>
+#include <string_view>
+#include <vector>
+
+using Coords = Coords_<int>;
+// Marks the border of the contraption.
+constexpr char OUTSIDE = 'X';
 
 struct Beam {
   // Bits encoding direction fitting into one byte.
@@ -29,21 +36,13 @@ struct Beam {
   }
 };
 
-std::vector<std::vector<char>>
-makeBeamDirectionsBFLike(const std::vector<std::string> &lines) {
-  std::vector<std::vector<char>> beamDirections;
-  std::vector<char> darkLine;
-  darkLine.resize(lines[0].size(), 0);
-  for (size_t i = 0; i < lines.size(); ++i) {
-    beamDirections.push_back(darkLine);
-  }
-  return beamDirections;
-}
-
-void printBeamDirections(std::vector<std::vector<char>> &beamDirections) {
-  for (auto &line : beamDirections) {
-    for (auto ch : line) {
-      if (ch != 0) {
+// The beam directions have the same shape as the grid, so both are accessed
+// with the same index.
+void printBeamDirections(const Grid<char> &grid,
+                         const char *beamDirections) {
+  for (int row = 0; row < grid.rows(); ++row) {
+    for (int col = 0; col < grid.cols(); ++col) {
+      if (beamDirections[grid.index(row, col)] != 0) {
         std::cout << "#";
       } else {
         std::cout << " ";
@@ -53,11 +52,12 @@ void printBeamDirections(std::vector<std::vector<char>> &beamDirections) {
   }
 }
 
-size_t countLit(std::vector<std::vector<char>> &beamDirections) {
+size_t countLit(const Grid<char> &grid, const char *beamDirections) {
   size_t lit = 0;
-  for (auto &line : beamDirections) {
-    for (auto ch : line) {
-      if (ch != 0) {
+  for (int row = 0; row < grid.rows(); ++row) {
+    const char *line = beamDirections + grid.index(row, 0);
+    for (int col = 0; col < grid.cols(); ++col) {
+      if (line[col] != 0) {
         ++lit;
       }
     }
@@ -65,109 +65,116 @@ size_t countLit(std::vector<std::vector<char>> &beamDirections) {
   return lit;
 }
 
-size_t simulateBeam(const std::vector<std::string> &lines,
-                    const Beam &initalBeam) {
-  auto beamDirections = makeBeamDirectionsBFLike(lines);
-  const size_t rows = lines.size();
-  const size_t cols = lines[0].size();
-  std::queue<Beam> beams;
+size_t simulateBeam(const Grid<char> &grid, const Beam &initalBeam) {
+  // Part 2 runs this on the threads of the pool, so each call rewinds the
+  // arena of its thread.
+  const ArenaScope scope;
+  // Same shape as grid.
+  char *beamDirections = scratchArena().makeArray<char>(grid.size(), 0);
+  std::queue<Beam, std::pmr::deque<Beam>> beams{
+      std::pmr::deque<Beam>(&scratchArena())};
   beams.push(initalBeam);
   while (!beams.empty()) {
     auto &b = beams.front();
     b.coords += b.dir;
-    if (b.coords.row >= 0 && b.coords.row < rows && b.coords.col >= 0 &&
-        b.coords.col < cols) {
-      auto &beamDirection = beamDirections[b.coords.row][b.coords.col];
-      // Log beam direction.
-      const char bd = static_cast<char>(b.dirBF());
-      if ((beamDirection & bd) != 0) {
-        // Already been at this cell with this direction.
-        beams.pop();
-        continue;
-      } else {
-        beamDirection = beamDirection | bd;
+    const ptrdiff_t index = grid.index(b.coords);
+    // Handle the cell content.
+    const char ch = grid[index];
+    if (ch == OUTSIDE) {
+      beams.pop();
+      continue;
+    }
+    auto &beamDirection = beamDirections[index];
+    // Log beam direction.
+    const char bd = static_cast<char>(b.dirBF());
+    if ((beamDirection & bd) != 0) {
+      // Already been at this cell with this direction.
+      beams.pop();
+      continue;
+    } else {
+      beamDirection = beamDirection | bd;
+    }
+    if (ch == '/') {
+      if (b.dir.col > 0) {
+        b.dir = Coords::Up();
+      } else if (b.dir.col < 0) {
+        b.dir = Coords::Down();
+      } else if (b.dir.row > 0) {
+        b.dir = Coords::Left();
+      } else if (b.dir.row < 0) {
+        b.dir = Coords::Right();
       }
-      // Handle the cell content.
-      const char ch = lines[b.coords.row][b.coords.col];
-      if (ch == '/') {
-        if (b.dir.col > 0) {
-          b.dir = Coords::Up();
-        } else if (b.dir.col < 0) {
-          b.dir = Coords::Down();
-        } else if (b.dir.row > 0) {
-          b.dir = Coords::Left();
-        } else if (b.dir.row < 0) {
-          b.dir = Coords::Right();
-        }
-      } else if (ch == '\\') {
-        if (b.dir.col > 0) {
-          b.dir = Coords::Down();
-        } else if (b.dir.col < 0) {
-          b.dir = Coords::Up();
-        } else if (b.dir.row > 0) {
-          b.dir = Coords::Right();
-        } else if (b.dir.row < 0) {
-          b.dir = Coords::Left();
-        }
-      } else if (ch == '|') {
-        if (b.dir.col != 0) {
-          // Split.
-          b.dir = Coords::Up();
-          beams.emplace(b.coords, Coords::Down());
-        }
-      } else if (ch == '-') {
-        if (b.dir.row != 0) {
-          // Split.
-          b.dir = Coords::Left();
-          beams.emplace(b.coords, Coords::Right());
-        }
+    } else if (ch == '\\') {
+      if (b.dir.col > 0) {
+        b.dir = Coords::Down();
+      } else if (b.dir.col < 0) {
+        b.dir = Coords::Up();
+      } else if (b.dir.row > 0) {
+        b.dir = Coords::Right();
+      } else if (b.dir.row < 0) {
+        b.dir = Coords::Left();
+      }
+    } else if (ch == '|') {
+      if (b.dir.col != 0) {
+        // Split.
+        b.dir = Coords::Up();
+        beams.emplace(b.coords, Coords::Down());
+      }
+    } else if (ch == '-') {
+      if (b.dir.row != 0) {
+        // Split.
+        b.dir = Coords::Left();
+        beams.emplace(b.coords, Coords::Right());
       }
-    } else {
-      // Out of bounds.
-      beams.pop();
     }
     // std::cout << "\nnext:\n";
-    // printBeamDirections(beamDirections);
+    // printBeamDirections(grid, beamDirections);
   }
   // std::cout << "\nfinal:\n";
-  // printBeamDirections(beamDirections);
-  return countLit(beamDirections);
+  // printBeamDirections(grid, beamDirections);
+  return countLit(grid, beamDirections);
 }
 
-void solvePart1(const std::vector<std::string> &lines) {
-  const auto lit = simulateBeam(lines, Beam(Coords(0, -1), Coords(0, 1)));
+void solvePart1(const std::vector<std::string_view> &lines) {
+  const auto grid = Grid<char>::fromLines(lines, OUTSIDE);
+  const auto lit = simulateBeam(grid, Beam(Coords(0, -1), Coords(0, 1)));
   std::cout << "Lit: " << lit << "\n";
 }
 
-void solvePart2(const std::vector<std::string> &lines) {
+void solvePart2(const std::vector<std::string_view> &lines) {
+  const auto grid = Grid<char>::fromLines(lines, OUTSIDE);
+  const int rows = grid.rows();
+  const int cols = grid.cols();
+  std::vector<Beam> entries;
   // Top, bottom
-  const size_t rows = lines.size();
-  const size_t cols = lines[0].size();
-  size_t maxLit = 0;
-  for (size_t col = 0; col < cols; ++col) {
-    maxLit = std::max(maxLit,
-                      simulateBeam(lines, Beam(Coords(-1, col), Coords(1, 0))));
-    maxLit = std::max(
-        maxLit, simulateBeam(lines, Beam(Coords(rows, col), Coords(-1, 0))));
+  for (int col = 0; col < cols; ++col) {
+    entries.emplace_back(Coords(-1, col), Coords(1, 0));
+    entries.emplace_back(Coords(rows, col), Coords(-1, 0));
   }
-  for (size_t row = 0; row < rows; ++row) {
-    maxLit = std::max(maxLit,
-                      simulateBeam(lines, Beam(Coords(row, -1), Coords(0, 1))));
-    maxLit = std::max(
-        maxLit, simulateBeam(lines, Beam(Coords(row, cols), Coords(0, -1))));
+  // Left, right
+  for (int row = 0; row < rows; ++row) {
+    entries.emplace_back(Coords(row, -1), Coords(0, 1));
+    entries.emplace_back(Coords(row, cols), Coords(0, -1));
   }
+  // The entry beams are independent.
+  const size_t maxLit = parallelReduce(
+      0, entries.size(), size_t(0),
+      [&](size_t i) { return simulateBeam(grid, entries[i]); },
+      [](size_t lhs, size_t rhs) { return std::max(lhs, rhs); });
   std::cout << "Max. lit: " << maxLit << "\n";
 }
 
-int main() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::vector<std::string> lines;
-  std::vector<std::vector<char>> lightDirs;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    lines.push_back(line);
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    // Each input is mapped by its part, as in the runner.
+    return batchMain(
+        argc, argv,
+        {{"Part 1", [] { solvePart1(InputFile(inputPath).lines()); }},
+         {"Part 2", [] { solvePart2(InputFile(inputPath).lines()); }}});
   }
+  const InputFile input(inputPath);
+  // const InputFile input("input_test.txt");
+  const auto &lines = input.lines();
   measureTime([&lines]() { solvePart1(lines); }, "Part 1");
   measureTime([&lines]() { solvePart2(lines); }, "Part 2");
   std::cout << "Done.\n";
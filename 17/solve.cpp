@@ -2,9 +2,14 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <functional>
 #include <limits>
+#include <memory_resource>
 #include <queue>
 #include <string>
+#include <string_view>
+
+using Coords = Coords_<int>;
 
 // Print found path through the maze. Requires more memory and slows down.
 //#define HISTORY = 1
@@ -67,14 +72,25 @@ bool operator<(const Node &lhs, const Node &rhs) {
   return -(lhs.totalPredictedCosts()) < -(rhs.totalPredictedCosts());
 }
 
-inline int costs(const std::vector<std::string> &lines, const Coords &coords) {
-  return lines[coords.row][coords.col] - '0';
+// Heat loss per block. The border has no costs, which marks it as outside.
+inline Grid<char> makeCostsGrid(const std::vector<std::string_view> &lines) {
+  auto grid = Grid<char>::fromLines(lines, 0);
+  for (int row = 0; row < grid.rows(); ++row) {
+    char *line = grid.row(row);
+    for (int col = 0; col < grid.cols(); ++col) {
+      line[col] -= '0';
+    }
+  }
+  return grid;
 }
 
 template <typename MoveConstraints> struct AStar {
-  AStar(const std::vector<std::string> &lines_)
-      : lines(lines_), moveConstraints(), rows(lines.size()),
-        cols(lines[0].size()), dest(rows - 1, cols - 1) {}
+  // Scratch memory of the search, taken from the arena.
+  using Queue = std::priority_queue<Node, std::pmr::vector<Node>>;
+
+  AStar(const std::vector<std::string_view> &lines)
+      : costs(makeCostsGrid(lines)), moveConstraints(), rows(costs.rows()),
+        cols(costs.cols()), dest(rows - 1, cols - 1) {}
 
   int solve() const {
     const Coords up(Coords::Up());
@@ -82,9 +98,11 @@ template <typename MoveConstraints> struct AStar {
     const Coords down(Coords::Down());
     const Coords right(Coords::Right());
 
-    std::vector<char> blackList(rows * cols * 40, 0);
+    // One entry per cell, direction and number of straight steps.
+    char *blackList = scratchArena().makeArray<char>(
+        static_cast<size_t>(rows) * cols * 4 * MoveConstraints::maxStraight, 0);
     // std::cout << "hashset size: " << blackList.size() << "\n";
-    std::priority_queue<Node> q;
+    Queue q{std::less<Node>(), std::pmr::vector<Node>(&scratchArena())};
     Coords start(0, 0);
     q.emplace(start, NONE, 0, dest);
     int finalCosts = std::numeric_limits<int>::max();
@@ -107,30 +125,23 @@ template <typename MoveConstraints> struct AStar {
 #endif
       }
       // Expand
-      if (n.coords.row > 0) {
-        tryExpandAndPush(n, UP, up, q, blackList);
-      }
-      if (n.coords.row < rows - 1) {
-        tryExpandAndPush(n, DOWN, down, q, blackList);
-      }
-      if (n.coords.col > 0) {
-        tryExpandAndPush(n, LEFT, left, q, blackList);
-      }
-      if (n.coords.col < cols - 1) {
-        tryExpandAndPush(n, RIGHT, right, q, blackList);
-      }
+      tryExpandAndPush(n, UP, up, q, blackList);
+      tryExpandAndPush(n, DOWN, down, q, blackList);
+      tryExpandAndPush(n, LEFT, left, q, blackList);
+      tryExpandAndPush(n, RIGHT, right, q, blackList);
     }
     return finalCosts;
   }
 
   inline bool tryExpandAndPush(const Node &base, char dir,
                                const Coords &dirCoords,
-                               std::priority_queue<Node> &q,
-                               std::vector<char> &blackList) const {
+                               Queue &q, char *blackList) const {
     bool ret = false;
-    if (moveConstraints.canMove(base, dir)) {
-      const Coords newCoords = base.coords + dirCoords;
-      const auto en = expand(base, dir, newCoords);
+    const Coords newCoords = base.coords + dirCoords;
+    const char newCosts = costs[newCoords];
+    // No costs means the move would leave the map.
+    if (newCosts != 0 && moveConstraints.canMove(base, dir)) {
+      const auto en = expand(base, dir, newCoords, newCosts);
       const auto enCosts = en.totalPredictedCosts();
       auto &alreadyEnqueuedOrProcessedCosts = blackList[hash(en)];
       if (alreadyEnqueuedOrProcessedCosts == 0 ||
@@ -149,12 +160,12 @@ template <typename MoveConstraints> struct AStar {
     return ret;
   }
 
-  inline Node expand(const Node &base, char dir,
-                     const Coords &newCoords) const {
+  inline Node expand(const Node &base, char dir, const Coords &newCoords,
+                     char newCosts) const {
     Node en(base);
     en.coords = newCoords;
     en.addDir(dir);
-    en.costsPast += costs(lines, newCoords);
+    en.costsPast += newCosts;
     en.costsFuturePredicted = heuristic(newCoords, dest);
 #ifdef HISTORY
     en.history += dirToArrow(dir);
@@ -165,13 +176,15 @@ template <typename MoveConstraints> struct AStar {
   inline size_t hash(const Node &node) const {
     assert(node.lastDir < 4);
     assert(node.lastDirCount > 0);
-    assert(node.lastDirCount <= 10);
-    return static_cast<size_t>(node.coords.row * cols + node.coords.col) * 4 *
-               10 +
-           static_cast<size_t>(node.lastDir * 10 + node.lastDirCount - 1);
+    assert(node.lastDirCount <= MoveConstraints::maxStraight);
+    constexpr size_t maxStraight = MoveConstraints::maxStraight;
+    return (static_cast<size_t>(node.coords.row) * cols + node.coords.col) *
+               4 * maxStraight +
+           static_cast<size_t>(node.lastDir * maxStraight +
+                               node.lastDirCount - 1);
   }
 
-  const std::vector<std::string> &lines;
+  const Grid<char> costs;
   const MoveConstraints moveConstraints;
   int rows;
   int cols;
@@ -179,6 +192,8 @@ template <typename MoveConstraints> struct AStar {
 };
 
 struct MoveConstraints1 {
+  static constexpr int maxStraight = 3;
+
   bool canMove(const Node &n, char dir) const {
     const bool initialMove = (n.lastDir == NONE);
     const bool reverse = (dir == UP && n.lastDir == DOWN) ||
@@ -193,6 +208,8 @@ struct MoveConstraints1 {
 };
 
 struct MoveConstraints2 {
+  static constexpr int maxStraight = 10;
+
   bool canMove(const Node &n, char dir) const {
     const bool initialMove = (n.lastDir == NONE);
     const bool reverse = (dir == UP && n.lastDir == DOWN) ||
@@ -210,27 +227,30 @@ struct MoveConstraints2 {
   bool canStop(const Node &n) const { return n.lastDirCount >= 4; }
 };
 
-void solvePart1(const std::vector<std::string> &lines) {
+void solvePart1(const std::vector<std::string_view> &lines) {
   const auto costs = AStar<MoveConstraints1>(lines).solve();
   std::cout << "Costs: " << costs << "\n";
 }
 
-void solvePart2(const std::vector<std::string> &lines) {
+void solvePart2(const std::vector<std::string_view> &lines) {
   const auto costs = AStar<MoveConstraints2>(lines).solve();
   std::cout << "Costs: " << costs << "\n";
 }
 
-int main() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  // std::ifstream ifs("input_test_2.txt");
-  std::vector<std::string> lines;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    lines.push_back(line);
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    // Each input is mapped by its part, as in the runner.
+    return batchMain(
+        argc, argv,
+        {{"Part 1", [] { solvePart1(InputFile(inputPath).lines()); }},
+         {"Part 2", [] { solvePart2(InputFile(inputPath).lines()); }}});
   }
-  measureTime([lines]() { solvePart1(lines); }, "Part 1");
-  measureTime([lines]() { solvePart2(lines); }, "Part 2");
+  const InputFile input(inputPath);
+  // const InputFile input("input_test.txt");
+  // const InputFile input("input_test_2.txt");
+  const auto &lines = input.lines();
+  measureTime([&lines]() { solvePart1(lines); }, "Part 1");
+  measureTime([&lines]() { solvePart2(lines); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
 }
\ No newline at end of file
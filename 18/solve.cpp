@@ -1,9 +1,9 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <optional>
-#include <sstream>
 #include <string>
 
 // Need to use a larger integer type for part 2.
@@ -148,48 +148,70 @@ private:
   }
 };
 
+void processStep1(std::string_view line, Processor &processor) {
+  Parser parser(line);
+  const char dir = parser.peek();
+  const int steps = parser.nextInt<int>();
+  processor.processStep(dir, steps);
+}
+
+void processStep2(std::string_view line, Processor &processor) {
+  Parser parser(line);
+  parser.skipPast('#');
+  // Extract steps and dir from hex string.
+  const int steps = parser.nextFixedInt<int>(5, 16);
+  const char dir = dirHexToCh[parser.peek() - '0'];
+  // std::cout << dir << " " << steps << "\n";
+  processor.processStep(dir, steps);
+}
+
+// The Processor only keeps the corners it needs, so the streamed lines (see
+// LineReader) may be of any number.
 void solvePart1() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string line;
+  LineReader reader(inputPath);
+  // LineReader reader("input_test.txt");
   Processor processor;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    char dir;
-    int steps;
-    iss >> dir >> steps;
-    processor.processStep(dir, steps);
-  }
+  reader.forEach(
+      [&](std::string_view line) { processStep1(line, processor); });
   const auto area = processor.finalize();
   std::cout << "Area: " << area << "\n";
-  assert(area == 40131);
 }
 
 void solvePart2() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string line;
+  LineReader reader(inputPath);
+  // LineReader reader("input_test.txt");
   Processor processor;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    char chJunk;
-    int iJunk;
-    std::string str;
-    iss >> chJunk >> iJunk >> str;
-    // Extract dir and steps from hex string.
-    const char dir = dirHexToCh[str[7] - '0'];
-    const std::string stepsHex = str.substr(2, 5); // Cut off () and #.
-    const int steps = std::stoi(stepsHex, nullptr, 16);
-    // std::cout << dir << " " << steps << "\n";
-    processor.processStep(dir, steps);
-  }
+  reader.forEach(
+      [&](std::string_view line) { processStep2(line, processor); });
   const auto area = processor.finalize();
   std::cout << "Area: " << area << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  Processor processor1;
+  Processor processor2;
+  reader.forEach([&](std::string_view line) {
+    processStep1(line, processor1);
+    processStep2(line, processor2);
+  });
+  std::cout << "Area: " << processor1.finalize() << "\n";
+  std::cout << "Area: " << processor2.finalize() << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
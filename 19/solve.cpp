@@ -1,9 +1,11 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
-#include <sstream>
 #include <string>
 #include <unordered_map>
 
@@ -66,6 +68,21 @@ struct RangedItem {
 
 enum class Action { FORWARD, ACCEPT, REJECT };
 
+// Step with indices instead of pointers, for the parse cache.
+struct StepRecord {
+  int8_t attr; // Index into attrs or -1.
+  char cmp;    // '<', '>' or 0.
+  uint8_t action;
+  int32_t reference;
+  uint32_t nextSuccess; // noStep if there is none.
+  uint32_t nextFailure;
+};
+inline constexpr uint32_t noStep = std::numeric_limits<uint32_t>::max();
+
+bool compareLT(int lhs, int rhs) { return lhs < rhs; }
+
+bool compareGT(int lhs, int rhs) { return lhs > rhs; }
+
 class Step {
 public:
   // Ctor for steps that always evaluate to success.
@@ -81,7 +98,7 @@ public:
         ret = nextSuccess->process(item);
       } else if (action == Action::ACCEPT) {
         ret = true;
-      } else if (action == Action::REJECT) {
+      } else { // Action::REJECT
         ret = false;
       }
     } else {
@@ -94,7 +111,48 @@ public:
   void setNextFailure(const Step *next_) { nextFailure = next_; }
   void setAction(Action action_) { action = action_; }
 
+  // The pointers are encoded relative to the first step.
+  StepRecord toRecord(const Step *first) const {
+    StepRecord record;
+    record.attr = -1;
+    for (size_t i = 0; i < attrs.size(); ++i) {
+      if (attr == attrs[i]) {
+        record.attr = static_cast<int8_t>(i);
+      }
+    }
+    record.cmp = cmp == &compareLT ? '<' : cmp == &compareGT ? '>' : 0;
+    record.action = static_cast<uint8_t>(action);
+    record.reference = reference;
+    record.nextSuccess =
+        nextSuccess ? static_cast<uint32_t>(nextSuccess - first) : noStep;
+    record.nextFailure =
+        nextFailure ? static_cast<uint32_t>(nextFailure - first) : noStep;
+    return record;
+  }
+
+  static Step fromRecord(const StepRecord &record, const Step *first) {
+    Step step;
+    if (record.attr >= 0) {
+      step.attr = attrs[record.attr];
+    }
+    step.cmp = record.cmp == '<'   ? &compareLT
+               : record.cmp == '>' ? &compareGT
+                                   : nullptr;
+    step.reference = record.reference;
+    step.action = static_cast<Action>(record.action);
+    if (record.nextSuccess != noStep) {
+      step.nextSuccess = first + record.nextSuccess;
+    }
+    if (record.nextFailure != noStep) {
+      step.nextFailure = first + record.nextFailure;
+    }
+    return step;
+  }
+
 private:
+  static constexpr std::array<int Item::*, 4> attrs = {&Item::x, &Item::m,
+                                                       &Item::a, &Item::s};
+
   int Item::*attr;
   bool (*cmp)(int lhs, int rhs);
   int reference;
@@ -103,6 +161,8 @@ private:
   const Step *nextFailure{nullptr};
 };
 
+// Work in progress for part 2.
+#if 0
 class RangedStep {
 public:
   enum class Comparison { LT, GT, NONE };
@@ -119,7 +179,7 @@ public:
         ret = nextSuccess->process(rangedItem);
       } else if (action == Action::ACCEPT) {
         ret = true;
-      } else if (action == Action::REJECT) {
+      } else { // Action::REJECT
         ret = false;
       }
     }
@@ -168,6 +228,7 @@ private:
   const RangedStep *nextSuccess{nullptr};
   const RangedStep *nextFailure{nullptr};
 };
+#endif
 
 inline std::string parseWorkflowName(const std::string &line, int &pos) {
   const auto epos = line.find('{', pos);
@@ -191,14 +252,12 @@ int Item::*chToAttr(char ch) {
     ret = &Item::a;
   } else if (ch == 's') {
     ret = &Item::s;
+  } else {
+    throw std::runtime_error(std::string("Unknown attribute ") + ch + ".");
   }
   return ret;
 }
 
-bool compareLT(int lhs, int rhs) { return lhs < rhs; }
-
-bool compareGT(int lhs, int rhs) { return lhs > rhs; }
-
 auto chToCmp(char ch) {
   bool (*ret)(int, int);
   if (ch == '<') {
@@ -222,9 +281,9 @@ inline Step parseStep(const std::string &line, int &pos) {
   auto attr = chToAttr(line[pos++]);
   // std::cout << " " << line[pos];
   auto cmp = chToCmp(line[pos++]);
-  const auto sepPos = line.find(':', pos);
-  const int reference = std::stoi(line.substr(pos, sepPos - pos));
-  pos = sepPos + 1;
+  Parser parser(std::string_view(line).substr(pos));
+  const int reference = parser.nextInt<int>();
+  pos += parser.position() + 1; // Skip :
   // std::cout << " " << reference << "\n";
   return Step(attr, cmp, reference);
 }
@@ -235,9 +294,9 @@ inline Step parseRangedStep(const std::string &line, int &pos) {
   auto attr = chToAttr(line[pos++]);
   // std::cout << " " << line[pos];
   auto cmp = chToCmp(line[pos++]);
-  const auto sepPos = line.find(':', pos);
-  const int reference = std::stoi(line.substr(pos, sepPos - pos));
-  pos = sepPos + 1;
+  Parser parser(std::string_view(line).substr(pos));
+  const int reference = parser.nextInt<int>();
+  pos += parser.position() + 1; // Skip :
   // std::cout << " " << reference << "\n";
   return Step(attr, cmp, reference);
 }
@@ -250,7 +309,24 @@ inline std::string parseDestName(const std::string &line, int &pos) {
   return ret;
 }
 
-template <typename T>
+// Workflow name to the index of its first step.
+using WorkflowMap = FlatHashMap<std::string, size_t>;
+
+// The lookup before WorkflowMap with the same interface, the reference for the
+// runner's --compare.
+class StdWorkflowMap {
+public:
+  const size_t *find(const std::string &name) const {
+    const auto it = map.find(name);
+    return it != map.end() ? &it->second : nullptr;
+  }
+  size_t &operator[](const std::string &name) { return map[name]; }
+
+private:
+  std::unordered_map<std::string, size_t> map;
+};
+
+template <typename Map, typename T>
 std::vector<T> parseSteps(std::ifstream &ifs,
                           T (*parseFunc)(const std::string &, int &),
                           Step *&outStepIn) {
@@ -258,7 +334,7 @@ std::vector<T> parseSteps(std::ifstream &ifs,
   std::string line;
   std::vector<T> steps;
   // For resolution of the next pointers:
-  std::unordered_map<std::string, size_t> wfMap;
+  Map wfMap;
   std::vector<std::string> nextSuccesses;
   std::string wfName;
   while (std::getline(ifs, line) && !line.empty()) {
@@ -269,10 +345,10 @@ std::vector<T> parseSteps(std::ifstream &ifs,
     }
     ++pos; // Skip {
     wfMap[wfName] = steps.size();
-    assert(pos < line.size() - 1);
     const auto ePos = line.size() - 1;
+    assert(static_cast<size_t>(pos) < ePos);
     // std::cout << "Workflow " << wfName << "\n";
-    while (pos < line.size() - 1) {
+    while (static_cast<size_t>(pos) < ePos) {
       if (isStep(line, pos)) {
         steps.push_back(parseFunc(line, pos));
         nextSuccesses.push_back(parseDestName(line, pos));
@@ -293,7 +369,10 @@ std::vector<T> parseSteps(std::ifstream &ifs,
         step.setAction(Action::REJECT);
       } else {
         step.setAction(Action::FORWARD);
-        step.setNextSuccess(&steps[wfMap[success]]);
+        // Workflows defined further down are resolved by a later pass.
+        if (const size_t *idx = wfMap.find(success)) {
+          step.setNextSuccess(&steps[*idx]);
+        }
       }
     }
   }
@@ -303,33 +382,78 @@ std::vector<T> parseSteps(std::ifstream &ifs,
   return steps;
 }
 
-Item parseItem(const std::string &line) {
+Item parseItem(std::string_view line) {
   Item ret;
-  int pos = 1; // Skip {
-  while (pos < line.size() - 1) {
-    const auto attr = chToAttr(line[pos]);
-    pos += 2; // Skip =
-    const auto commaPos = std::min(line.size() - 1, line.find(',', pos));
-    const auto valueStr = line.substr(pos, commaPos - pos);
-    // std::cout << valueStr << "\n";
-    const int value = std::stoi(valueStr);
-    pos = commaPos + 1;
-    ret.*attr = value;
+  Parser parser(line);
+  parser.skip(1); // Skip {
+  while (!parser.done() && parser.peek() != '}') {
+    const auto attr = chToAttr(parser.peek());
+    ret.*attr = parser.nextInt<int>(); // Skips =
+    parser.consume(',');
   }
   return ret;
 }
 
-void solvePart1() {
-  std::ifstream ifs("input.txt");
+// The workflows and the parts to sort.
+struct System {
+  std::vector<Step> steps;
+  size_t in; // Index of the first step of workflow "in".
+  std::vector<Item> items;
+};
+
+template <typename Map> System parseSystem() {
+  std::ifstream ifs(inputPath);
   // std::ifstream ifs("input_test.txt");
+  System system;
   Step *stepIn = nullptr;
-  const auto steps = parseSteps(ifs, &parseStep, stepIn);
+  system.steps = parseSteps<Map>(ifs, &parseStep, stepIn);
   assert(stepIn != nullptr);
+  // Moving the steps kept their addresses.
+  system.in = stepIn - system.steps.data();
   std::string line;
-  size_t sum = 0;
   while (std::getline(ifs, line)) {
-    Item item = parseItem(line);
-    if (stepIn->process(item)) {
+    system.items.push_back(parseItem(line));
+  }
+  return system;
+}
+
+// The System from the parse cache if it is enabled and up to date.
+template <typename Map> System loadSystem() {
+  if (!parseCacheEnabled()) {
+    return parseSystem<Map>();
+  }
+  const ParseCache cache(inputPath, "system", 1);
+  if (auto reader = cache.load()) {
+    System system;
+    const auto [records, count] = reader->readArray<StepRecord>();
+    system.steps.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      system.steps[i] = Step::fromRecord(records[i], system.steps.data());
+    }
+    system.in = reader->read<uint64_t>();
+    system.items = reader->readVector<Item>();
+    return system;
+  }
+  System system = parseSystem<Map>();
+  std::vector<StepRecord> records;
+  records.reserve(system.steps.size());
+  for (const auto &step : system.steps) {
+    records.push_back(step.toRecord(system.steps.data()));
+  }
+  CacheWriter writer;
+  writer.writeArray(records);
+  writer.write<uint64_t>(system.in);
+  writer.writeArray(system.items);
+  cache.store(writer);
+  return system;
+}
+
+template <typename Map = WorkflowMap> void solvePart1() {
+  const System system = loadSystem<Map>();
+  const Step &stepIn = system.steps[system.in];
+  size_t sum = 0;
+  for (const auto &item : system.items) {
+    if (stepIn.process(item)) {
       sum += item.sum();
     }
   }
@@ -340,8 +464,12 @@ void solvePart2() {
   // TODO
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1<>}, {"Part 2", &solvePart2}});
+  }
+  measureTime(&solvePart1<>, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
   return 0;
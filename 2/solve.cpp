@@ -1,7 +1,7 @@
 #include "utils.h"
+#include <array>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 
 inline int colorToInt(char c) {
   if (c == 'r') {
@@ -15,58 +15,85 @@ inline int colorToInt(char c) {
   }
 }
 
+// Whether the game in the line could have been played with the given cubes.
+bool isPossible(std::string_view line) {
+  static constexpr std::array<int, 3> maxNums = {12, 13, 14};
+  Parser parser(line);
+  parser.skipPast(':'); // Skip game id.
+  do {
+    const int num = parser.nextInt<int>();
+    const auto color = parser.nextWord();
+    if (num > maxNums[colorToInt(color[0])]) {
+      return false;
+    }
+  } while (!parser.done());
+  return true;
+}
+
+// Power of the fewest cubes the game in the line could have been played with.
+int minPower(std::string_view line) {
+  std::array<int, 3> counts = {0, 0, 0};
+  Parser parser(line);
+  parser.skipPast(':'); // Skip game id.
+  do {
+    const int num = parser.nextInt<int>();
+    const auto color = parser.nextWord();
+    int &count = counts[colorToInt(color[0])];
+    count = std::max(count, num);
+  } while (!parser.done());
+  return counts[0] * counts[1] * counts[2];
+}
+
+// The games are streamed (see LineReader), so the input may be of any size.
 void solvePart1() {
-  std::ifstream is("input.txt");
-  std::string line;
-  std::array<int, 3> maxNums = {12, 13, 14};
-  int sum = 0;
-  int id = 0;
-  while (std::getline(is, line)) {
+  LineReader reader(inputPath);
+  long long sum = 0;
+  long long id = 0;
+  reader.forEach([&](std::string_view line) {
     ++id;
-    bool possible = true;
-    auto start = line.find(':') + 1; // Skip game id.
-    int num;
-    std::string color;
-    std::istringstream is(&line.c_str()[start]);
-    do {
-      is >> num >> color;
-      if (num > maxNums[colorToInt(color[0])]) {
-        possible = false;
-        break;
-      }
-    } while (!is.eof());
-    if (possible) {
+    if (isPossible(line)) {
       sum += id;
     }
-  }
+  });
   std::cout << sum << "\n";
 }
 
 void solvePart2() {
-  std::ifstream is("input.txt");
-  std::string line;
-  int sum = 0;
-  int id = 0;
-  while (std::getline(is, line)) {
-    ++id;
-    std::array<int, 3> counts = {0, 0, 0};
-    auto start = line.find(':') + 1; // Skip game id.
-    int num;
-    std::string color;
-    std::istringstream is(&line.c_str()[start]);
-    do {
-      is >> num >> color;
-      int &count = counts[colorToInt(color[0])];
-      count = std::max(count, num);
-    } while (!is.eof());
-    sum += counts[0] * counts[1] * counts[2];
-  }
+  LineReader reader(inputPath);
+  long long sum = 0;
+  reader.forEach([&](std::string_view line) { sum += minPower(line); });
   std::cout << sum << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  long long sum1 = 0;
+  long long sum2 = 0;
+  long long id = 0;
+  reader.forEach([&](std::string_view line) {
+    ++id;
+    if (isPossible(line)) {
+      sum1 += id;
+    }
+    sum2 += minPower(line);
+  });
+  std::cout << sum1 << "\n";
+  std::cout << sum2 << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
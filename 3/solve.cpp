@@ -1,40 +1,26 @@
 #include "utils.h"
+#include <charconv>
 #include <fstream>
 #include <iostream>
+#include <string_view>
 #include <vector>
 
 inline bool isSymbol(char ch) { return (ch != '.' && !isDigit(ch)); }
 
-inline bool checkHasAdjacentSymbol(const std::vector<std::string> &lines,
-                                   int row, int colStart, int colEnd) {
-  // Above
-  if (row > 0) {
-    const auto &lineAbove = lines[row - 1];
-    for (int col = std::max(0, colStart - 1);
-         col < std::min(static_cast<int>(lineAbove.size()), colEnd + 1);
-         ++col) {
-      if (isSymbol(lineAbove[col])) {
-        return true;
-      }
-    }
-  }
-  // Current line
-  // Left
-  const auto &line = lines[row];
-  if (colStart > 0 && isSymbol(line[colStart - 1])) {
-    return true;
-  }
-  // Right
-  if (colEnd < line.size() && isSymbol(line[colEnd])) {
-    return true;
-  }
-  // Next line
-  if (row + 1 < lines.size()) {
-    const auto &lineBelow = lines[row + 1];
-    for (int col = std::max(0, colStart - 1);
-         col < std::min(static_cast<int>(lineBelow.size()), colEnd + 1);
-         ++col) {
-      if (isSymbol(lineBelow[col])) {
+inline int toInt(std::string_view str) {
+  int ret = 0;
+  std::from_chars(str.data(), str.data() + str.size(), ret);
+  return ret;
+}
+
+// The border of the grid is filled with '.', so the cells around the number
+// can be checked without bounds checks.
+inline bool checkHasAdjacentSymbol(const Grid<char> &grid, int row,
+                                   int colStart, int colEnd) {
+  for (int r = row - 1; r <= row + 1; ++r) {
+    const char *line = grid.row(r);
+    for (int col = colStart - 1; col <= colEnd; ++col) {
+      if (isSymbol(line[col])) {
         return true;
       }
     }
@@ -43,18 +29,14 @@ inline bool checkHasAdjacentSymbol(const std::vector<std::string> &lines,
 }
 
 void solvePart1() {
-  std::ifstream is("input.txt");
-  std::vector<std::string> lines;
-  std::string line;
-  while (std::getline(is, line)) {
-    lines.emplace_back();
-    lines.back().swap(line);
-  }
+  const InputFile input(inputPath);
+  const auto grid = Grid<char>::fromLines(input.lines(), '.');
   int sum = 0;
-  for (int row = 0; row < static_cast<int>(lines.size()); ++row) {
-    const auto &line = lines[row];
+  for (int row = 0; row < grid.rows(); ++row) {
+    const char *line = grid.row(row);
     int colNumStart = -1;
-    for (int col = 0; col < static_cast<int>(line.size()); ++col) {
+    // The border terminates numbers at the end of the line.
+    for (int col = 0; col <= grid.cols(); ++col) {
       const char ch = line[col];
       if (colNumStart == -1) {
         if (isDigit(ch)) {
@@ -63,23 +45,14 @@ void solvePart1() {
       } else {
         if (!isDigit(ch)) {
           // Complete number.
-          if (checkHasAdjacentSymbol(lines, row, colNumStart, col)) {
-            auto numStr = line.substr(colNumStart, col - colNumStart);
-            sum += std::stoi(numStr);
+          if (checkHasAdjacentSymbol(grid, row, colNumStart, col)) {
+            sum += toInt(std::string_view(line + colNumStart,
+                                          col - colNumStart));
           }
           colNumStart = -1;
         }
       }
     }
-    if (colNumStart != -1) {
-      // Number ends with end of line.
-      if (checkHasAdjacentSymbol(lines, row, colNumStart, line.size())) {
-        auto numStr = line.substr(colNumStart, line.size() - colNumStart);
-        // std::cout << "Add " << numStr << " (eol)\n";
-        sum += std::stoi(numStr);
-      }
-      colNumStart = -1;
-    }
   }
   std::cout << "Sum: " << sum << "\n";
 }
@@ -109,50 +82,24 @@ struct StarLinesBuffer {
   std::vector<StarCell> curStarLine;
   std::vector<StarCell> nextStarLine;
 
+  // One extra cell on both sides for the border of the grid.
   StarLinesBuffer(size_t cols)
-      : prevStarLine(cols), curStarLine(cols), nextStarLine(cols) {}
-
-  inline void updatePrevLine(const std::string &prevLine, int number,
-                             int colStart, int colEnd) {
-    for (int col = std::max(0, colStart - 1);
-         col < std::min(static_cast<int>(prevLine.size()), colEnd + 1); ++col) {
-      if (prevLine[col] == '*') {
-        prevStarLine[col].addNumber(number);
-      }
-    }
-  }
-
-  inline void updateCurLine(const std::string &curLine, int number,
-                            int colStart, int colEnd) {
-    // Left
-    if (colStart > 0 && curLine[colStart - 1] == '*') {
-      curStarLine[colStart - 1].addNumber(number);
-    }
-    // Right
-    if (colEnd < curLine.size() && curLine[colEnd] == '*') {
-      curStarLine[colEnd].addNumber(number);
-    }
-  }
+      : prevStarLine(cols + 2), curStarLine(cols + 2), nextStarLine(cols + 2) {}
 
-  inline void updateNextLine(const std::string &nextLine, int number,
-                             int colStart, int colEnd) {
-    for (int col = std::max(0, colStart - 1);
-         col < std::min(static_cast<int>(nextLine.size()), colEnd + 1); ++col) {
-      if (nextLine[col] == '*') {
-        nextStarLine[col].addNumber(number);
+  inline void updateLine(const char *line, std::vector<StarCell> &starLine,
+                         int number, int colStart, int colEnd) {
+    for (int col = colStart - 1; col <= colEnd; ++col) {
+      if (line[col] == '*') {
+        starLine[col + 1].addNumber(number);
       }
     }
   }
 
-  inline void update(const std::vector<std::string> &lines, int row, int number,
+  inline void update(const Grid<char> &grid, int row, int number,
                      int colStart, int colEnd) {
-    if (row > 0) {
-      updatePrevLine(lines[row - 1], number, colStart, colEnd);
-    }
-    updateCurLine(lines[row], number, colStart, colEnd);
-    if (row < lines.size()) {
-      updateNextLine(lines[row + 1], number, colStart, colEnd);
-    }
+    updateLine(grid.row(row - 1), prevStarLine, number, colStart, colEnd);
+    updateLine(grid.row(row), curStarLine, number, colStart, colEnd);
+    updateLine(grid.row(row + 1), nextStarLine, number, colStart, colEnd);
   }
 
   inline int evalPrevLine() {
@@ -170,19 +117,15 @@ struct StarLinesBuffer {
 };
 
 void solvePart2() {
-  std::ifstream is("input.txt");
-  std::vector<std::string> lines;
-  std::string line;
-  while (std::getline(is, line)) {
-    lines.emplace_back();
-    lines.back().swap(line);
-  }
-  StarLinesBuffer buffer(lines[0].size());
+  const InputFile input(inputPath);
+  const auto grid = Grid<char>::fromLines(input.lines(), '.');
+  StarLinesBuffer buffer(grid.cols());
   int sum = 0;
-  for (int row = 0; row < static_cast<int>(lines.size()); ++row) {
-    const auto &line = lines[row];
+  for (int row = 0; row < grid.rows(); ++row) {
+    const char *line = grid.row(row);
     int colNumStart = -1;
-    for (int col = 0; col < static_cast<int>(line.size()); ++col) {
+    // The border terminates numbers at the end of the line.
+    for (int col = 0; col <= grid.cols(); ++col) {
       const char ch = line[col];
       if (colNumStart == -1) {
         if (isDigit(ch)) {
@@ -192,26 +135,23 @@ void solvePart2() {
         if (!isDigit(ch)) {
           // Complete number.
           const auto number =
-              std::stoi(line.substr(colNumStart, col - colNumStart));
-          buffer.update(lines, row, number, colNumStart, col);
+              toInt(std::string_view(line + colNumStart, col - colNumStart));
+          buffer.update(grid, row, number, colNumStart, col);
           colNumStart = -1;
         }
       }
     }
-    if (colNumStart != -1) {
-      // Number ends with end of line.
-      const auto number =
-          std::stoi(line.substr(colNumStart, line.size() - colNumStart));
-      buffer.update(lines, row, number, colNumStart, line.size());
-      colNumStart = -1;
-    }
     sum += buffer.evalPrevLine();
     buffer.cycle();
   }
   std::cout << "Sum: " << sum << "\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
@@ -1,98 +1,158 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
+#include <deque>
 #include <fstream>
 #include <iostream>
-#include <numeric>
-#include <sstream>
+#include <unordered_set>
+#include <vector>
 
+constexpr int numWins = 10;
+// constexpr int numWins = 5; // input_test.txt
+
+// Number of drawn numbers on the card in the line that are winning numbers.
+// winningNumbers holds the last game a number was a winning number in, so it
+// never has to be cleared.
+// Faster than set and unordered_set for this case. Probably because it uses
+// no dynamic allocations and also O(1). The runner's --compare measures it
+// against solvePart1Set().
+// Assumes numWins winning numbers per card and numbers below 100, other inputs
+// fail the asserts instead of indexing out of bounds.
+int countMatches(std::string_view line, std::array<int, 100> &winningNumbers,
+                 int game) {
+  Parser parser(line);
+  parser.skipPast(':'); // Skip card id.
+  for (int i = 0; i < numWins; ++i) {
+    const short int win = parser.nextInt<short int>();
+    assert(win >= 0 && static_cast<size_t>(win) < winningNumbers.size());
+    winningNumbers[win] = game;
+  }
+  parser.skipWhitespace();
+  assert(parser.peek() == '|');
+  int matches = 0;
+  short int drawn;
+  while (parser.tryNextInt(drawn)) {
+    assert(drawn >= 0 && static_cast<size_t>(drawn) < winningNumbers.size());
+    if (winningNumbers[drawn] == game) {
+      ++matches;
+    }
+  }
+  return matches;
+}
+
+int points(int matches) { return matches > 0 ? 1 << (matches - 1) : 0; }
+
+// The cards are streamed (see LineReader), so the input may be of any size.
 void solvePart1() {
-  int sum = 0;
-  std::ifstream is("input.txt");
-  // Faster than set and unordered_set for this case. Probably because it uses
-  // no dynamic allocations and also O(1). Times: array took 0.519549 ms
-  // unordered set took 1.47268 ms
-  // set took 1.6033 ms
-  std::array<short, 100> winningNumbers;
+  LineReader reader(inputPath);
+  std::array<int, 100> winningNumbers;
   winningNumbers.fill(0);
-  std::string line;
+  long long sum = 0;
   int game = 1;
-  while (std::getline(is, line)) {
+  reader.forEach([&](std::string_view line) {
+    sum += points(countMatches(line, winningNumbers, game));
+    ++game;
+  });
+  std::cout << "Sum: " << sum << "\n";
+}
+
+// Part 1 with a set of the winning numbers, the reference for the array.
+void solvePart1Set() {
+  int sum = 0;
+  LineReader reader(inputPath);
+  std::unordered_set<short int> winningNumbers;
+  std::string_view line;
+  while (reader.next(line)) {
     int points = 0;
-    std::istringstream iss(&line.c_str()[10]);
-    for (int i = 0; i < 10; ++i) {
-      short int win;
-      iss >> win;
-      winningNumbers[win] = game;
+    Parser parser(line);
+    parser.skipPast(':'); // Skip card id.
+    winningNumbers.clear();
+    for (int i = 0; i < numWins; ++i) {
+      winningNumbers.insert(parser.nextInt<short int>());
     }
-    char separator;
-    iss >> separator;
-    assert(separator == '|');
-    while (!iss.eof()) {
-      short int drawn;
-      iss >> drawn;
-      if (winningNumbers[drawn] == game) {
+    parser.skipWhitespace();
+    assert(parser.peek() == '|');
+    short int drawn;
+    while (parser.tryNextInt(drawn)) {
+      if (winningNumbers.count(drawn) > 0) {
         points = std::max(1, points * 2);
       }
     }
     sum += points;
-    ++game;
   }
   std::cout << "Sum: " << sum << "\n";
 }
 
-void solvePart2() {
-  std::ifstream is("input.txt");
-  constexpr int trimLeft = 10;
-  constexpr int numWins = 10;
-  constexpr int numLines = 192;
+// Copies of the upcoming cards won so far. A card only wins copies of the next
+// numWins cards, so the counts of those are all we need to keep instead of one
+// per card. Copies of cards past the end are never collected.
+class CopyCounter {
+public:
+  // Returns the instances of the next card, which has the given matches.
+  size_t add(int matches) {
+    size_t instances = 1; // Original
+    if (!pending.empty()) {
+      instances += pending.front();
+      pending.pop_front();
+    }
+    if (pending.size() < static_cast<size_t>(matches)) {
+      pending.resize(matches, 0);
+    }
+    for (int i = 0; i < matches; ++i) {
+      pending[i] += instances;
+    }
+    return instances;
+  }
 
-  // std::ifstream is("input_test.txt");
-  // constexpr int trimLeft = 9;
-  // constexpr int numWins = 5;
-  // constexpr int numLines = 6;
+private:
+  std::deque<size_t> pending;
+};
 
-  std::array<short, 100> winningNumbers;
-  std::array<size_t, numLines + 1> numCopies;
+void solvePart2() {
+  LineReader reader(inputPath);
+  std::array<int, 100> winningNumbers;
   winningNumbers.fill(0);
-  numCopies.fill(1); // Original
-  numCopies[0] = 0;
+  CopyCounter copies;
+  size_t sum = 0;
   int game = 1;
-  std::string line;
-  while (std::getline(is, line)) {
-    int points = 0;
-    std::istringstream iss(&line.c_str()[trimLeft]);
-    for (int i = 0; i < numWins; ++i) {
-      short int win;
-      iss >> win;
-      winningNumbers[win] = game;
-    }
-    char separator;
-    iss >> separator;
-    assert(separator == '|');
-    while (!iss.eof()) {
-      short int drawn;
-      iss >> drawn;
-      if (winningNumbers[drawn] == game) {
-        ++points;
-      }
-    }
-    // std::cout << game << ": " << numCopies[game] << "x points: " << points <<
-    // "\n";
-    points = std::min(game + points + 1, static_cast<int>(numCopies.size()));
-    for (short i = game + 1; i < points; ++i) {
-      numCopies[i] += numCopies[game];
-    }
+  reader.forEach([&](std::string_view line) {
+    sum += copies.add(countMatches(line, winningNumbers, game));
     ++game;
-  }
-  const size_t sum = std::accumulate(
-      numCopies.begin(), numCopies.end(),
-      static_cast<size_t>(0)); // Card "0" is not counted in the array.
+  });
   std::cout << "Sum: " << sum << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  std::array<int, 100> winningNumbers;
+  winningNumbers.fill(0);
+  CopyCounter copies;
+  long long sum1 = 0;
+  size_t sum2 = 0;
+  int game = 1;
+  reader.forEach([&](std::string_view line) {
+    const int matches = countMatches(line, winningNumbers, game);
+    sum1 += points(matches);
+    sum2 += copies.add(matches);
+    ++game;
+  });
+  std::cout << "Sum: " << sum1 << "\n";
+  std::cout << "Sum: " << sum2 << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
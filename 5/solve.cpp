@@ -1,8 +1,10 @@
 #include "utils.h"
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory_resource>
 #include <vector>
 
 using num = long long;
@@ -13,6 +15,10 @@ using num = long long;
 // Vector as underlying container -> few allocations
 template <typename T> class LinkedVector {
 public:
+  explicit LinkedVector(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : data(resource) {}
+
   static constexpr size_t npos = static_cast<size_t>(-1);
   struct Element {
     size_t prev;
@@ -67,18 +73,18 @@ public:
   bool empty() { return size == 0; }
 
 private:
-  std::vector<Element> data;
+  std::pmr::vector<Element> data;
   size_t head = npos;
   size_t tail = npos;
   size_t size = 0;
 };
 
-inline std::vector<num> parseNumList(const std::string &line, size_t start) {
+inline std::vector<num> parseNumList(std::string_view line, size_t start) {
   std::vector<num> seeds;
-  std::stringstream ss(&line.c_str()[7]);
-  while (!ss.eof()) {
-    num seed;
-    ss >> seed;
+  Parser parser(line);
+  parser.skip(start);
+  num seed;
+  while (parser.tryNextInt(seed)) {
     seeds.emplace_back(seed);
   }
   return seeds;
@@ -95,23 +101,19 @@ struct Range {
   }
 };
 
-std::istream &operator>>(std::istream &is, Range &range) {
-  is >> range.start >> range.length;
-  return is;
-}
-
 bool operator<(const Range &lhs, const Range &rhs) {
   return lhs.start < rhs.start;
 }
 
-inline LinkedVector<Range> parseRangeList(const std::string &line,
-                                          size_t start) {
-  LinkedVector<Range> seeds;
-  std::stringstream ss(&line.c_str()[7]);
-  while (!ss.eof()) {
-    num start, length;
-    ss >> start >> length;
-    seeds.push_back(Range(start, length));
+inline LinkedVector<Range> parseRangeList(std::string_view line,
+                                          size_t start,
+                                          std::pmr::memory_resource *resource) {
+  LinkedVector<Range> seeds(resource);
+  Parser parser(line);
+  parser.skip(start);
+  num rangeStart;
+  while (parser.tryNextInt(rangeStart)) {
+    seeds.push_back(Range(rangeStart, parser.nextInt<num>()));
   }
   return seeds;
 }
@@ -160,29 +162,83 @@ struct Map {
   }
 };
 
-std::istream &operator>>(std::istream &is, Map &map) {
-  is >> map.destStart >> map.srcStart >> map.length;
-  return is;
+inline Map parseMap(std::string_view line) {
+  Parser parser(line);
+  const num destStart = parser.nextInt<num>();
+  const num srcStart = parser.nextInt<num>();
+  return Map(destStart, srcStart, parser.nextInt<num>());
 }
 
-void solvePart1() {
-  // std::ifstream is("input_test.txt");
-  std::ifstream is("input.txt");
+// The seeds line and the maps of each x-to-y stage in order.
+struct Almanac {
+  std::pmr::string seeds;
+  std::pmr::vector<std::pmr::vector<Map>> stages;
+
+  explicit Almanac(std::pmr::memory_resource *resource)
+      : seeds(resource), stages(resource) {}
+};
+
+// Streams the input, mapping it costs more than it saves on an input this
+// small.
+Almanac parseAlmanac(std::pmr::memory_resource *resource) {
+  ScopedTimer timer("parse");
+  std::ifstream is(inputPath);
+  Almanac almanac(resource);
+  // std::getline is only fast for std::string.
   std::string line;
   std::getline(is, line);
+  almanac.seeds = line;
+  while (std::getline(is, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if (!std::isdigit(static_cast<unsigned char>(line[0]))) {
+      // x-to-y map
+      almanac.stages.emplace_back();
+      continue;
+    }
+    almanac.stages.back().push_back(parseMap(line));
+  }
+  return almanac;
+}
+
+// The Almanac from the parse cache if it is enabled and up to date.
+Almanac loadAlmanac(std::pmr::memory_resource *resource) {
+  if (!parseCacheEnabled()) {
+    return parseAlmanac(resource);
+  }
+  const ParseCache cache(inputPath, "almanac", 1);
+  if (auto reader = cache.load()) {
+    Almanac almanac(resource);
+    almanac.seeds = reader->readString();
+    almanac.stages.resize(reader->read<uint64_t>());
+    for (auto &stage : almanac.stages) {
+      const auto [maps, count] = reader->readArray<Map>();
+      stage.assign(maps, maps + count);
+    }
+    return almanac;
+  }
+  Almanac almanac = parseAlmanac(resource);
+  CacheWriter writer;
+  writer.writeString(almanac.seeds);
+  writer.write<uint64_t>(almanac.stages.size());
+  for (const auto &stage : almanac.stages) {
+    writer.writeArray(stage.data(), stage.size());
+  }
+  cache.store(writer);
+  return almanac;
+}
+
+void solvePart1() {
+  const Almanac almanac = loadAlmanac(&scratchArena());
+  ScopedTimer timer("map seeds");
   std::vector<num> cur;
-  std::vector<num> next = parseNumList(line, 7);
-  std::getline(is, line);
-  Map map;
-  num offset;
+  std::vector<num> next = parseNumList(almanac.seeds, 7);
   num mapped;
-  while (is) {
+  for (const auto &stage : almanac.stages) {
     std::swap(cur, next);
     next = cur;
-    std::getline(is, line); // x-to-y map
-    while (std::getline(is, line) && !line.empty()) {
-      std::stringstream ss(line);
-      ss >> map;
+    for (Map map : stage) {
       for (size_t i = 0; i < cur.size(); ++i) {
         num c = cur[i];
         if (map(c, mapped)) {
@@ -205,24 +261,16 @@ void printRanges(LinkedVector<Range> ranges) {
 }
 
 void solvePart2() {
-  // std::ifstream is("input_test.txt");
-  std::ifstream is("input.txt");
-  std::string line;
-  std::getline(is, line);
-  LinkedVector<Range> cur;
-  auto next = parseRangeList(line, 7);
-  std::getline(is, line);
-  Map map;
-  num offset;
-  num mapped;
-  while (is) {
+  const Almanac almanac = loadAlmanac(&scratchArena());
+  ScopedTimer timer("map ranges");
+  // The ranges are scratch memory of the run.
+  LinkedVector<Range> cur(&scratchArena());
+  auto next = parseRangeList(almanac.seeds, 7, &scratchArena());
+  for (const auto &stage : almanac.stages) {
     std::swap(cur, next);
     next.clear();
     // printRanges(cur);
-    std::getline(is, line); // x-to-y map
-    while (std::getline(is, line) && !line.empty()) {
-      std::stringstream ss(line);
-      ss >> map;
+    for (Map map : stage) {
       // std::cout << map.srcStart << ", len " << map.length << " ---> "
       //          << map.destStart << ", len " << map.length << ": "
       //          << cur.count() << "x\n";
@@ -246,7 +294,11 @@ void solvePart2() {
   std::cout << lowestLocation << "\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
@@ -2,35 +2,44 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 
 using num = long long;
 
-inline std::vector<int> parseList(const std::string &line, size_t start) {
+inline std::vector<int> parseList(std::string_view line, size_t start) {
   int num;
   std::vector<int> list;
-  std::istringstream iss(&line.c_str()[start]);
-  while (!iss.eof()) {
-    iss >> num;
+  Parser parser(line);
+  parser.skip(start);
+  while (parser.tryNextInt(num)) {
     list.push_back(num);
   }
   return list;
 }
 
-inline std::pair<num, num> solveQuadratic(num duration, num minDist) {
-  const double d = static_cast<double>(duration);
-  const double w = static_cast<double>(minDist);
-  double x1 = (-d - std::sqrt(d * d - 4 * w)) / -2;
-  double x2 = (-d + std::sqrt(d * d - 4 * w)) / -2;
-  if (x2 < x1) {
-    std::swap(x1, x2);
+// Floor of the square root, exact unlike std::sqrt on doubles and usable at
+// compile time.
+constexpr num isqrt(num n) {
+  if (n < 2) {
+    return n < 0 ? 0 : n;
   }
-  //std::cout << x1 << ", " << x2 << "\n";
-  num i1 = static_cast<num>(x1) - 1;
-  num i2 = static_cast<num>(x2) + 1;
-  // Deal with floating point boundary values.
+  num x = n;
+  num y = (x + 1) / 2;
+  while (y < x) {
+    x = y;
+    y = (x + n / x) / 2;
+  }
+  return x;
+}
+
+// First and last charging time that travels further than minDist, i.e. the
+// integers between the roots of t * (duration - t) = minDist.
+constexpr std::pair<num, num> solveQuadratic(num duration, num minDist) {
+  const num root = isqrt(duration * duration - 4 * minDist);
+  num i1 = (duration - root) / 2 - 1;
+  num i2 = (duration + root) / 2 + 1;
+  // Deal with the rounding of the square root.
   while (i1 * (duration - i1) <= minDist) {
     ++i1;
   }
@@ -40,15 +49,60 @@ inline std::pair<num, num> solveQuadratic(num duration, num minDist) {
   return std::make_pair(i1, i2);
 }
 
+// Part 1 of a whole input, for the embedded build (see common/embed.h).
+constexpr num productOfWays(std::string_view input) {
+  const size_t lineEnd = input.find('\n');
+  Parser durations(input.substr(0, lineEnd));
+  Parser distances(input.substr(lineEnd + 1));
+  num prod = 1;
+  num duration = 0;
+  num distance = 0;
+  while (durations.tryNextInt(duration) && distances.tryNextInt(distance)) {
+    const auto solutions = solveQuadratic(duration, distance);
+    prod *= solutions.second + 1 - solutions.first;
+  }
+  return prod;
+}
+
+// Part 2 reads the numbers of a line as one, ignoring the spaces.
+constexpr num kernedNumber(std::string_view line) {
+  num value = 0;
+  for (const char ch : line) {
+    if ('0' <= ch && ch <= '9') {
+      value = value * 10 + (ch - '0');
+    }
+  }
+  return value;
+}
+
+constexpr num numWaysKerned(std::string_view input) {
+  const size_t lineEnd = input.find('\n');
+  const auto sol = solveQuadratic(kernedNumber(input.substr(0, lineEnd)),
+                                  kernedNumber(input.substr(lineEnd + 1)));
+  return sol.second + 1 - sol.first;
+}
+
 std::ostream &operator<<(std::ostream &os,
                          const std::pair<double, double> &interval) {
   os << "[" << interval.first << ", " << interval.second << "]";
   return os;
 }
 
+#ifdef AOC_EMBED_INPUT
+// The answers are computed by the compiler, see common/embed.h.
+void solvePart1() {
+  constexpr num prod = productOfWays(embeddedInput);
+  std::cout << "Product: " << prod << "\n";
+}
+
+void solvePart2() {
+  constexpr num number = numWaysKerned(embeddedInput);
+  std::cout << "Number: " << number << "\n";
+}
+#else
 void solvePart1() {
   //std::ifstream is("input_test.txt");
-  std::ifstream is("input.txt");
+  std::ifstream is(inputPath);
   constexpr int lineStart = 10;
   std::string line;
   std::getline(is, line);
@@ -73,8 +127,13 @@ void solvePart2() {
   const auto num = sol.second  + 1 - sol.first;
   std::cout << "Number: " << num << "\n";
 }
+#endif
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
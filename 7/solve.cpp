@@ -1,16 +1,64 @@
 #include "utils.h"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <vector>
 
 using ValueArray = std::array<char, 5>;
 
+// Rates the hands in a batch of lines and appends them. The rating is
+// independent per hand, so it runs in parallel.
+template <typename Hand, typename ToValues>
+void appendHands(const std::vector<std::string_view> &lines,
+                 ToValues toValues, std::vector<Hand> &hands) {
+  const size_t first = hands.size();
+  hands.resize(first + lines.size());
+  parallelFor(0, lines.size(), [&](size_t i) {
+    Parser parser(lines[i]);
+    const auto valuesString = parser.nextWord();
+    const auto bid = parser.nextInt<short int>();
+    hands[first + i] = Hand(toValues(valuesString), bid);
+  });
+}
+
+// Only the sorting needs all hands.
+template <typename Hand> long long totalWinnings(std::vector<Hand> &hands) {
+  std::sort(hands.begin(), hands.end());
+  long long sum = 0;
+  for (size_t i = 0; i < hands.size(); ++i) {
+    sum += (i + 1) * hands[i].bid;
+    // std::cout << hands[i].typeValue << ", " << hands[i].cardValue << " -> "
+    // << hands[i].bid << "\n";
+  }
+  return sum;
+}
+
+// All hands of a whole input, for the embedded build (see common/embed.h).
+// Without allocations, the number of hands has to be known at compile time.
+template <typename Hand, size_t N, typename ToValues>
+constexpr long long totalWinningsOf(std::string_view input,
+                                    ToValues toValues) {
+  std::array<Hand, N> hands{};
+  size_t i = 0;
+  forEachRecord(input, '\n', [&](std::string_view line) {
+    Parser parser(line);
+    const auto valuesString = parser.nextWord();
+    const auto bid = parser.nextInt<short int>();
+    hands[i++] = Hand(toValues(valuesString), bid);
+  });
+  constexprSort(hands.begin(), hands.end());
+  long long sum = 0;
+  for (size_t j = 0; j < N; ++j) {
+    sum += (j + 1) * hands[j].bid;
+  }
+  return sum;
+}
+
 // Part 1
-ValueArray stringToValueArray1(const std::string &s) {
-  ValueArray values;
+constexpr ValueArray stringToValueArray1(std::string_view s) {
+  ValueArray values{};
   for (size_t i = 0; i < s.size(); ++i) {
     const char ch = s[i];
     if (ch <= '9') {
@@ -32,7 +80,7 @@ ValueArray stringToValueArray1(const std::string &s) {
 }
 
 struct Hand1 {
-  static inline void updateType(int sameCount, int &highestTypeValue) {
+  static constexpr void updateType(int sameCount, int &highestTypeValue) {
     int value = 10 * sameCount;
     if (value == 20) {
       if (highestTypeValue == 20) {
@@ -53,9 +101,10 @@ struct Hand1 {
     }
   }
 
-  Hand1(const ValueArray &values, short int bid_) : bid(bid_) {
+  Hand1() = default;
+  constexpr Hand1(const ValueArray &values, short int bid_) : bid(bid_) {
     ValueArray sorted = values;
-    std::sort(sorted.begin(), sorted.end());
+    constexprSort(sorted.begin(), sorted.end());
     int sameCount = 1;
     for (size_t i = 1; i < sorted.size(); ++i) {
       if (sorted[i] == sorted[i - 1]) {
@@ -73,11 +122,11 @@ struct Hand1 {
   }
   int typeValue = 0;
   unsigned int cardValue = 0;
-  short int bid;
+  short int bid = 0;
 };
 
-bool operator<(const Hand1 &lhs, const Hand1 &rhs) {
-  bool ret;
+constexpr bool operator<(const Hand1 &lhs, const Hand1 &rhs) {
+  bool ret = false;
   if (lhs.typeValue == rhs.typeValue) {
     ret = lhs.cardValue < rhs.cardValue;
   } else {
@@ -86,35 +135,12 @@ bool operator<(const Hand1 &lhs, const Hand1 &rhs) {
   return ret;
 }
 
-void solvePart1() {
-  // std::ifstream ifs("input_test.txt");
-  std::ifstream ifs("input.txt");
-  std::vector<Hand1> hands;
-  hands.reserve(1000);
-  std::string line;
-  std::string valuesString;
-  short int bid;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    iss >> valuesString >> bid;
-    hands.emplace_back(stringToValueArray1(valuesString), bid);
-  }
-  std::sort(hands.begin(), hands.end());
-  int sum = 0;
-  for (size_t i = 0; i < hands.size(); ++i) {
-    sum += (i + 1) * hands[i].bid;
-    // std::cout << hands[i].typeValue << ", " << hands[i].cardValue << " -> "
-    // << hands[i].bid << "\n";
-  }
-  std::cout << "Sum: " << sum << "\n";
-}
-
 // Part 2
 constexpr char JOKER_2 = 0;
 
-ValueArray stringToValueArray2(const std::string &s) {
+constexpr ValueArray stringToValueArray2(std::string_view s) {
   // Unlike in the first part JOKER is now the weakest!
-  ValueArray values;
+  ValueArray values{};
   for (size_t i = 0; i < s.size(); ++i) {
     const char ch = s[i];
     if (ch <= '9') {
@@ -136,7 +162,7 @@ ValueArray stringToValueArray2(const std::string &s) {
 }
 
 struct Hand2 {
-  static inline void updateType(int sameCount, int &highestTypeValue) {
+  static constexpr void updateType(int sameCount, int &highestTypeValue) {
     int value = 10 * sameCount;
     if (value == 20) {
       if (highestTypeValue == 20) {
@@ -157,7 +183,7 @@ struct Hand2 {
     }
   }
 
-  static inline void upgradeType(int &typeValue) {
+  static constexpr void upgradeType(int &typeValue) {
     if (typeValue == 35) {
       typeValue = 40;
     } else {
@@ -165,9 +191,10 @@ struct Hand2 {
     }
   }
 
-  Hand2(const ValueArray &values, short int bid_) : bid(bid_) {
+  Hand2() = default;
+  constexpr Hand2(const ValueArray &values, short int bid_) : bid(bid_) {
     ValueArray sorted = values;
-    std::sort(sorted.begin(), sorted.end());
+    constexprSort(sorted.begin(), sorted.end());
     int sameCount = 1;
     int jokerCount = 0;
     for (size_t i = 1; i < sorted.size(); ++i) {
@@ -195,14 +222,14 @@ struct Hand2 {
       cardValue = cardValue * 13 + values[i];
     }
   }
-  ValueArray sortedHand;
+  ValueArray sortedHand{};
   int typeValue = 0;
   unsigned int cardValue = 0;
-  short int bid;
+  short int bid = 0;
 };
 
-bool operator<(const Hand2 &lhs, const Hand2 &rhs) {
-  bool ret;
+constexpr bool operator<(const Hand2 &lhs, const Hand2 &rhs) {
+  bool ret = false;
   if (lhs.typeValue == rhs.typeValue) {
     ret = lhs.cardValue < rhs.cardValue;
   } else {
@@ -211,33 +238,74 @@ bool operator<(const Hand2 &lhs, const Hand2 &rhs) {
   return ret;
 }
 
+#ifdef AOC_EMBED_INPUT
+// The answers are computed by the compiler, see common/embed.h.
+constexpr size_t numEmbeddedHands = countRecords(embeddedInput, '\n');
+
+void solvePart1() {
+  constexpr long long sum = totalWinningsOf<Hand1, numEmbeddedHands>(
+      embeddedInput, &stringToValueArray1);
+  std::cout << "Sum: " << sum << "\n";
+}
+
+void solvePart2() {
+  constexpr long long sum = totalWinningsOf<Hand2, numEmbeddedHands>(
+      embeddedInput, &stringToValueArray2);
+  std::cout << "Sum: " << sum << "\n";
+}
+#else
+// The lines are streamed in batches (see LineReader), only the rated hands are
+// kept.
+void solvePart1() {
+  // LineReader reader("input_test.txt");
+  LineReader reader(inputPath);
+  std::vector<std::string_view> lines;
+  std::vector<Hand1> hands;
+  while (reader.nextBatch(lines)) {
+    appendHands(lines, &stringToValueArray1, hands);
+  }
+  std::cout << "Sum: " << totalWinnings(hands) << "\n";
+}
+
 void solvePart2() {
-  // std::ifstream ifs("input_test.txt");
-  //std::ifstream ifs("input_test2.txt");
-  std::ifstream ifs("input.txt");
+  // LineReader reader("input_test.txt");
+  // LineReader reader("input_test2.txt");
+  LineReader reader(inputPath);
+  std::vector<std::string_view> lines;
   std::vector<Hand2> hands;
-  hands.reserve(1000);
-  std::string line;
-  std::string valuesString;
-  short int bid;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    iss >> valuesString >> bid;
-    hands.emplace_back(stringToValueArray2(valuesString), bid);
+  while (reader.nextBatch(lines)) {
+    appendHands(lines, &stringToValueArray2, hands);
   }
-  std::sort(hands.begin(), hands.end());
-  int sum = 0;
-  for (size_t i = 0; i < hands.size(); ++i) {
-    sum += (i + 1) * hands[i].bid;
-    // std::cout << hands[i].typeValue << ", " << hands[i].cardValue << " -> "
-    //          << hands[i].bid << "\n";
+  std::cout << "Sum: " << totalWinnings(hands) << "\n";
+}
+#endif
+
+// Both parts in a single pass, for input that can only be read once.
+void solveBothParts() {
+  LineReader reader(inputPath);
+  std::vector<std::string_view> lines;
+  std::vector<Hand1> hands1;
+  std::vector<Hand2> hands2;
+  while (reader.nextBatch(lines)) {
+    appendHands(lines, &stringToValueArray1, hands1);
+    appendHands(lines, &stringToValueArray2, hands2);
   }
-  std::cout << "Sum: " << sum << "\n";
+  std::cout << "Sum: " << totalWinnings(hands1) << "\n";
+  std::cout << "Sum: " << totalWinnings(hands2) << "\n";
 }
 
-int main() {
-  measureTime(&solvePart1, "Part 1");
-  measureTime(&solvePart2, "Part 2");
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
+  if (inputIsStdin()) {
+    measureTime(&solveBothParts, "Both parts");
+  } else {
+    measureTime(&solvePart1, "Part 1");
+    measureTime(&solvePart2, "Part 2");
+  }
   std::cout << "Done.\n";
   return 0;
 }
\ No newline at end of file
@@ -1,92 +1,140 @@
 #include "utils.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
-constexpr short int ZZZ = 25 * 26 * 26 + 25 * 26 + 25;
-constexpr short int MAP_SIZE = ZZZ + 1;
+using Node = std::array<int, 2>; // Destination index for L = 0 and R = 1.
 
-using Node = std::array<short int, 2>; // Destination index for L = 0 and R = 1.
-using NodeMap = std::array<Node, MAP_SIZE>;
+// Node names are mapped to dense indices in the order they appear, so neither
+// the number of nodes nor the length of their names is limited. The views
+// point into the input or the parse cache.
+struct Network {
+  std::string_view input;
+  std::pmr::vector<Node> nodes;
+  std::pmr::vector<std::string_view> names;
 
-short int tripletToInt(const char *triplet) {
-  int ret = triplet[0] - 'A';
-  ret = ret * 26 + triplet[1] - 'A';
-  ret = ret * 26 + triplet[2] - 'A';
-  return ret;
+  explicit Network(std::pmr::memory_resource *resource)
+      : nodes(resource), names(resource) {}
+
+  // Only used for a few nodes, a search is cheaper than building an index.
+  int at(std::string_view name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == name) {
+        return static_cast<int>(i);
+      }
+    }
+    throw std::runtime_error("Unknown node " + std::string(name) + ".");
+  }
+};
+
+// The network and the index of the names are allocated from resource.
+inline Network parseNetwork(std::string_view text,
+                            std::pmr::memory_resource *resource) {
+  std::vector<std::string_view> lines;
+  indexLines(text, lines);
+  Network network(resource);
+  network.input = lines[0];
+  // lines[1] is empty.
+  network.nodes.reserve(lines.size());
+  network.names.reserve(lines.size());
+  FlatHashMap<std::string_view, int, FlatHash<std::string_view>,
+              std::equal_to<>, std::pmr::polymorphic_allocator<char>>
+      indices(resource);
+  indices.reserve(lines.size());
+  const auto indexOf = [&](std::string_view name) {
+    const auto [index, inserted] =
+        indices.tryEmplace(name, static_cast<int>(network.names.size()));
+    if (inserted) {
+      network.names.push_back(name);
+      network.nodes.push_back({-1, -1});
+    }
+    return *index;
+  };
+  for (size_t i = 2; i < lines.size(); ++i) {
+    Parser parser(lines[i]);
+    const int src = indexOf(parser.nextWord());
+    parser.skipPast('(');
+    const int destL = indexOf(parser.nextUntil(','));
+    parser.skipWhitespace();
+    const int destR = indexOf(parser.nextUntil(')'));
+    network.nodes[src] = {destL, destR};
+  }
+  return network;
 }
 
-inline void loadInput1(std::ifstream &ifs, std::string &input,
-                       NodeMap &nodeMap) {
-  std::getline(ifs, input);
-  std::string line;
-  std::getline(ifs, line); // Empty
-  // Load graph.
-  std::string src, destL, destR;
-  char equals;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    iss >> src >> equals >> destL >> destR;
-    // std::cout << src << ": " << destL << ", " << destR << "\n";
-    auto &node = nodeMap[tripletToInt(&src[0])];
-    node[0] = tripletToInt(&destL[1]); // Cut off leading "(".
-    node[1] = tripletToInt(&destR[0]);
+// Valid as long as the cache lives and resource keeps its memory.
+inline Network loadNetwork(const ParseCache &cache,
+                           std::pmr::memory_resource *resource) {
+  if (auto reader = cache.load()) {
+    Network network(resource);
+    network.input = reader->readString();
+    const auto [nodes, count] = reader->readArray<Node>();
+    network.nodes.assign(nodes, nodes + count);
+    network.names.resize(reader->read<uint64_t>());
+    for (auto &name : network.names) {
+      name = reader->readString();
+    }
+    return network;
   }
+  Network network = parseNetwork(cache.input(), resource);
+  CacheWriter writer;
+  writer.writeString(network.input);
+  writer.writeArray(network.nodes.data(), network.nodes.size());
+  writer.write<uint64_t>(network.names.size());
+  for (const auto name : network.names) {
+    writer.writeString(name);
+  }
+  cache.store(writer);
+  return network;
 }
 
 void solvePart1() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string input;
-  NodeMap nodeMap;
-  loadInput1(ifs, input, nodeMap);
+  const ParseCache cache(inputPath, "network", 1);
+  // const ParseCache cache("input_test.txt", "network", 1);
+  const Network network = loadNetwork(cache, &scratchArena());
+  const auto &input = network.input;
 
   // Traverse graph using input.
   bool found = false;
-  short int cur = tripletToInt("AAA");
+  int cur = network.at("AAA");
+  const int dest = network.at("ZZZ");
   int steps = 0;
   do {
     for (size_t i = 0; i < input.size() && !found; ++i) {
       short int dir = (input[i] == 'L' ? 0 : 1);
-      cur = nodeMap[cur][dir];
-      found = (cur == ZZZ);
+      cur = network.nodes[cur][dir];
+      found = (cur == dest);
       ++steps;
     }
   } while (!found);
   std::cout << "Steps: " << steps << "\n";
 }
 
-inline void loadInput2(std::ifstream &ifs, std::string &input,
-                       std::vector<short int> &startNodes, NodeMap &nodeMap) {
-  std::getline(ifs, input);
-  std::string line;
-  std::getline(ifs, line); // Empty
-  // Load graph.
-  std::string src, destL, destR;
-  char equals;
-  while (std::getline(ifs, line)) {
-    std::istringstream iss(line);
-    iss >> src >> equals >> destL >> destR;
-    // std::cout << src << ": " << destL << ", " << destR << "\n";
-    short int srcInt = tripletToInt(&src[0]);
-    auto &node = nodeMap[srcInt];
-    node[0] = tripletToInt(&destL[1]); // Cut off leading "(".
-    node[1] = tripletToInt(&destR[0]);
-    if (src[2] == 'A') {
-      // Nodes ending on A are starting nodes.
-      startNodes.push_back(srcInt);
+// Nodes ending on A are starting nodes.
+inline std::vector<int> findStartNodes(const Network &network) {
+  std::vector<int> startNodes;
+  for (size_t i = 0; i < network.names.size(); ++i) {
+    if (network.names[i].back() == 'A') {
+      startNodes.push_back(static_cast<int>(i));
     }
   }
+  return startNodes;
 }
 
-inline bool isFinalNode(short int nodeInt) { return (nodeInt % 26) == 25; }
+inline bool isFinalNode(const Network &network, int node) {
+  return network.names[node].back() == 'Z';
+}
 
-constexpr inline unsigned int
-encodeState(short int nodeInt, unsigned short int inputStep, size_t size) {
-  return nodeInt * size + inputStep;
+constexpr inline size_t encodeState(int node, size_t inputStep,
+                                    size_t inputSize) {
+  return node * inputSize + inputStep;
 }
 
 struct FinalStepFunc {
@@ -109,41 +157,52 @@ struct FinalStepFunc {
   }
 };
 
-std::vector<FinalStepFunc> deriveFuncs(const NodeMap &nodeMap,
-                                       const std::string &input,
-                                       std::vector<short int> &curs) {
-  std::vector<FinalStepFunc> funcs;
+FinalStepFunc deriveFunc(const Network &network, int cur) {
+  const auto &input = network.input;
   // Find out when the pattern repeats: The first step at which the state of
   // (node ID, input index) has been visited already.
-  std::vector<bool> map; // true means that we were in this state already.
-  map.resize(encodeState(ZZZ, nodeMap.size(), nodeMap.size()));
-  for (auto &cur : curs) {
-    int found = 0;
-    size_t steps = 1;
-    std::fill(map.begin(), map.end(), false);
-    map[encodeState(cur, 0, nodeMap.size())] = true;
-    std::vector<size_t> finalSteps;
-    do {
-      for (size_t i = 0; i < input.size() && found < 3; ++i, ++steps) {
-        short int dir = (input[i] == 'L' ? 0 : 1);
-        cur = nodeMap[cur][dir];
-        if (isFinalNode(cur)) {
-          finalSteps.push_back(steps);
-        }
-        if (map[encodeState(cur, i, nodeMap.size())]) {
-          ++found;
-          std::fill(map.begin(), map.end(), false);
-        }
-        map[encodeState(cur, i, nodeMap.size())] = true;
+  // One bit per state, set if we were in this state already. The ghosts run
+  // on the threads of the pool, so each call rewinds the arena of its thread.
+  // The arena can back the bits with huge pages (AOC_HUGE_PAGES).
+  const ArenaScope scope;
+  const size_t numWords = (network.nodes.size() * input.size() + 63) / 64;
+  uint64_t *map = scratchArena().makeArray<uint64_t>(numWords, 0);
+  const auto bit = [](size_t state) { return uint64_t(1) << (state % 64); };
+  int found = 0;
+  size_t steps = 1;
+  size_t state = encodeState(cur, 0, input.size());
+  map[state / 64] |= bit(state);
+  std::vector<size_t> finalSteps;
+  do {
+    for (size_t i = 0; i < input.size() && found < 3; ++i, ++steps) {
+      short int dir = (input[i] == 'L' ? 0 : 1);
+      cur = network.nodes[cur][dir];
+      if (isFinalNode(network, cur)) {
+        finalSteps.push_back(steps);
       }
-    } while (found < 3);
-    const int m = finalSteps[1] - finalSteps[0];
-    const int c = finalSteps[0];
-    funcs.emplace_back(m, c);
-    if (m * 2 + c != finalSteps[2]) {
-      throw std::runtime_error("Could not derive linear function parameters.");
+      state = encodeState(cur, i, input.size());
+      if (map[state / 64] & bit(state)) {
+        ++found;
+        std::fill(map, map + numWords, 0);
+      }
+      map[state / 64] |= bit(state);
     }
+  } while (found < 3);
+  const int m = finalSteps[1] - finalSteps[0];
+  const int c = finalSteps[0];
+  if (static_cast<size_t>(m * 2 + c) != finalSteps[2]) {
+    throw std::runtime_error("Could not derive linear function parameters.");
   }
+  return FinalStepFunc(m, c);
+}
+
+std::vector<FinalStepFunc> deriveFuncs(const Network &network,
+                                       const std::vector<int> &curs) {
+  std::vector<FinalStepFunc> funcs(curs.size(), FinalStepFunc(0, 0));
+  // The ghosts are independent.
+  parallelFor(0, curs.size(), [&](size_t i) {
+    funcs[i] = deriveFunc(network, curs[i]);
+  });
   return funcs;
 }
 
@@ -162,18 +221,20 @@ size_t findCommonFinalStep(std::vector<FinalStepFunc> &funcs) {
 }
 
 void solvePart2() {
-  std::ifstream ifs("input.txt");
-  //std::ifstream ifs("input_test2.txt");
-  std::string input;
-  NodeMap nodeMap;
-  std::vector<short int> curs;
-  loadInput2(ifs, input, curs, nodeMap);
-  auto funcs = deriveFuncs(nodeMap, input, curs);
+  const ParseCache cache(inputPath, "network", 1);
+  // const ParseCache cache("input_test2.txt", "network", 1);
+  const Network network = loadNetwork(cache, &scratchArena());
+  const std::vector<int> curs = findStartNodes(network);
+  auto funcs = deriveFuncs(network, curs);
   const auto steps = findCommonFinalStep(funcs);
   std::cout << "Steps: " << steps << "\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";
@@ -2,15 +2,13 @@
 #include <fstream>
 #include <string>
 #include <vector>
-#include <sstream>
 #include "utils.h"
 
-std::vector<int> parseNumbers(const std::string& line) {
-  std::istringstream is(line);
+std::vector<int> parseNumbers(std::string_view line) {
+  Parser parser(line);
   std::vector<int> values;
   int v;
-  while (!is.eof()) {
-    is >> v;
+  while (parser.tryNextInt(v)) {
     values.push_back(v);
   }
   return values;
@@ -32,7 +30,7 @@ int extrapolatePrev(const std::vector<std::vector<int>>& derivatives) {
   return value;
 }
 
-std::vector<std::vector<int>> derive(const std::string& line) {
+std::vector<std::vector<int>> derive(std::string_view line) {
   std::vector<std::vector<int>> derivatives;
   derivatives.emplace_back(parseNumbers(line));
   bool allZero = true;
@@ -51,15 +49,16 @@ std::vector<std::vector<int>> derive(const std::string& line) {
   return derivatives;
 }
 
+// A single pass over the streamed lines (see LineReader), so the input may be
+// of any size and may come from stdin.
 void solveBothParts() {
-  std::ifstream ifs("input.txt");
-  std::string line;
+  LineReader reader(inputPath);
   long long sumNext = 0, sumPrev = 0;
-  while (std::getline(ifs, line)) {
+  reader.forEach([&](std::string_view line) {
     auto derivatives = derive(line);
     sumNext += extrapolateNext(derivatives);
     sumPrev += extrapolatePrev(derivatives);
-  }
+  });
   std::cout << "Sum next (part 1): " << sumNext << "\n";
   std::cout << "Sum prev (part 2): " << sumPrev << "\n";
 }
@@ -68,7 +67,12 @@ void solvePart2() {
   // TODO
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Both parts", &solveBothParts}});
+  }
+  setInputPath(argc, argv);
   measureTime(&solveBothParts, "Both parts");
   std::cout << "Done.\n";
   return 0;
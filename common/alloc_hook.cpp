@@ -0,0 +1,42 @@
+// Replacement of the global operator new / delete counting into
+// allocCounters. Only linked when building with ALLOC_STATS=1.
+
+#include "alloc_stats.h"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+static void *countedAlloc(size_t size) {
+  void *ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  auto &counters = allocCounters;
+  ++counters.allocs;
+  counters.bytes += size;
+  // The usable size, since operator delete doesn't always know the size.
+  counters.liveBytes += ::malloc_usable_size(ptr);
+  if (counters.liveBytes > counters.peakLiveBytes) {
+    counters.peakLiveBytes = counters.liveBytes;
+  }
+  return ptr;
+}
+
+static void countedFree(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  auto &counters = allocCounters;
+  ++counters.frees;
+  counters.liveBytes -= ::malloc_usable_size(ptr);
+  std::free(ptr);
+}
+
+// The nothrow and aligned variants of the standard library forward to these
+// or don't allocate through them at all.
+void *operator new(size_t size) { return countedAlloc(size); }
+void *operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void *ptr) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { countedFree(ptr); }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocation accounting. Building with ALLOC_STATS=1 defines
+// AOC_ALLOC_STATS and links alloc_hook.cpp, which replaces the global
+// operator new / delete and counts into the counters of the allocating
+// thread. Otherwise the counters stay zero and cost nothing.
+
+#ifdef AOC_ALLOC_STATS
+inline constexpr bool allocStatsEnabled = true;
+#else
+inline constexpr bool allocStatsEnabled = false;
+#endif
+
+struct AllocCounters {
+  size_t allocs = 0;
+  size_t frees = 0;
+  size_t bytes = 0;
+  // Usable size of the blocks, memory freed by another thread than the one
+  // which allocated it makes this negative.
+  long long liveBytes = 0;
+  long long peakLiveBytes = 0;
+};
+
+inline thread_local AllocCounters allocCounters;
+
+// Allocations between construction and finish() of the current thread.
+class AllocScope {
+public:
+  AllocScope() : start(allocCounters) {
+    allocCounters.peakLiveBytes = allocCounters.liveBytes;
+  }
+
+  // Counts since the construction. The peak is relative to the live bytes at
+  // the construction.
+  AllocCounters finish() const {
+    const AllocCounters &now = allocCounters;
+    AllocCounters ret;
+    ret.allocs = now.allocs - start.allocs;
+    ret.frees = now.frees - start.frees;
+    ret.bytes = now.bytes - start.bytes;
+    ret.liveBytes = now.liveBytes - start.liveBytes;
+    ret.peakLiveBytes = now.peakLiveBytes - start.liveBytes;
+    return ret;
+  }
+
+private:
+  AllocCounters start;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "huge_pages.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump-pointer arena for the scratch memory of a solver run. Allocating is
+// moving a pointer, deallocating does nothing. Rewinding keeps the chunks, so
+// once a run has grown the arena, the following runs don't touch the heap.
+// It is a std::pmr::memory_resource, i.e. std::pmr containers take it:
+//   std::pmr::vector<int> values(&scratchArena());
+// With AOC_HUGE_PAGES set, chunks of 512 KiB and more are rounded up to whole
+// huge pages and mapped from huge_pages.h.
+
+class Arena : public std::pmr::memory_resource {
+public:
+  // Position to rewind to, see mark().
+  struct Marker {
+    size_t chunk;
+    size_t offset;
+  };
+
+  explicit Arena(size_t chunkSize_ = 64 * 1024) : chunkSize(chunkSize_) {}
+
+  ~Arena() override {
+    for (const auto &chunk : chunks) {
+      if (chunk.hugePages) {
+        freeHugePages(chunk.data, chunk.size);
+      } else {
+        ::operator delete(chunk.data);
+      }
+    }
+  }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  Marker mark() const { return Marker{current, offset}; }
+
+  // Frees everything allocated since the marker at once. Memory allocated
+  // before the marker stays valid.
+  void rewind(const Marker &marker) {
+    current = marker.chunk;
+    offset = marker.offset;
+  }
+
+  void reset() { rewind(Marker{0, 0}); }
+
+  size_t capacity() const {
+    size_t ret = 0;
+    for (const auto &chunk : chunks) {
+      ret += chunk.size;
+    }
+    return ret;
+  }
+
+  // Array of n copies of value, valid until the arena is rewound. Unlike
+  // std::pmr containers, which construct their elements one by one through the
+  // allocator, this fills the array at once. That is a memset for bytes, even
+  // in unoptimized builds. The arena never runs destructors, so T has to be
+  // trivially destructible.
+  template <typename T> T *makeArray(size_t n, const T &value) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "The arena doesn't run destructors.");
+    T *ret = static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    std::uninitialized_fill_n(ret, n, value);
+    return ret;
+  }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    while (current < chunks.size()) {
+      const size_t start = alignedOffset(chunks[current], offset, alignment);
+      if (start + bytes <= chunks[current].size) {
+        offset = start + bytes;
+        return chunks[current].data + start;
+      }
+      // Try the next chunk. The rest of this one is wasted until rewound.
+      if (current + 1 < chunks.size() &&
+          chunks[current + 1].size >= bytes + alignment) {
+        ++current;
+        offset = 0;
+        continue;
+      }
+      break;
+    }
+    // Double the chunks, so the number of chunks stays logarithmic.
+    const size_t size =
+        std::max({chunkSize, bytes + alignment,
+                  chunks.empty() ? size_t(0) : chunks.back().size * 2});
+    const size_t index = chunks.empty() ? 0 : current + 1;
+    chunks.insert(chunks.begin() + index, newChunk(size));
+    current = index;
+    offset = 0;
+    return do_allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *, size_t, size_t) override {}
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  struct Chunk {
+    char *data;
+    size_t size;
+    bool hugePages = false;
+  };
+
+  static Chunk newChunk(size_t size) {
+    const HugePageMode mode = hugePageMode();
+    if (mode != HugePageMode::off && size >= hugePageSize / 4) {
+      const size_t bytes = hugePageBytes(size);
+      if (void *data = allocateHugePages(bytes, mode)) {
+        return Chunk{static_cast<char *>(data), bytes, true};
+      }
+    }
+    return Chunk{static_cast<char *>(::operator new(size)), size};
+  }
+
+  static size_t alignedOffset(const Chunk &chunk, size_t offset,
+                              size_t alignment) {
+    const auto address = reinterpret_cast<uintptr_t>(chunk.data) + offset;
+    const auto aligned = (address + alignment - 1) & ~(alignment - 1);
+    return offset + (aligned - address);
+  }
+
+  size_t chunkSize;
+  std::vector<Chunk> chunks;
+  size_t current = 0;
+  size_t offset = 0;
+};
+
+// Arena of the current thread. measureTime() rewinds it after each run, so
+// memory taken from it must not outlive the run. Tasks on the thread pool
+// have to rewind it themselves, e.g. with an ArenaScope per task.
+inline Arena &scratchArena() {
+  static thread_local Arena arena;
+  return arena;
+}
+
+// Rewinds the arena to where it was at construction.
+class ArenaScope {
+public:
+  explicit ArenaScope(Arena &arena_ = scratchArena())
+      : arena(arena_), marker(arena_.mark()) {}
+  ~ArenaScope() { arena.rewind(marker); }
+
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+  Arena &arena;
+  Arena::Marker marker;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "arena.h"
+#include "bench.h"
+#include "format.h"
+#include "input.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batch mode: Solves many inputs in one process instead of paying the process
+// startup per input. A batch is either a directory (all regular files in it)
+// or a manifest file listing one input per line, optionally preceded by its
+// day ("7 inputs/a.txt"). Relative paths in a manifest are relative to the
+// manifest. Empty lines and lines starting with '#' are skipped.
+// The inputs are spread over a pool of threads. Each one runs all parts once,
+// without repetitions, and the results are streamed to std::cout as JSON
+// lines as soon as its parts are done, in the order they finish:
+//   {"input":"a.txt","day":7,"part":"Part 1","ms":1.2,"answer":"Sum: 42"}
+// A failing part has "error" instead of "answer". The throughput is printed to
+// std::cerr at the end.
+// Usage for a day: ./solve --batch <dir|manifest> [-j <threads>]
+// The runner takes --batch as well (see runner.cpp).
+
+struct BatchInput {
+  std::string path;
+  int day = 0; // From the manifest, 0 if not given.
+};
+
+struct BatchPart {
+  std::string name;
+  std::function<void()> func;
+};
+
+// One input with the parts to solve on it.
+struct BatchTask {
+  std::string path;
+  int day = 0; // Only reported, if known.
+  const std::vector<BatchPart> *parts = nullptr;
+  std::string label = {}; // Reported instead of the path if not empty.
+};
+
+inline std::vector<BatchInput> loadBatch(const std::string &source) {
+  namespace fs = std::filesystem;
+  std::vector<BatchInput> inputs;
+  if (fs::is_directory(source)) {
+    for (const auto &entry : fs::directory_iterator(source)) {
+      if (entry.is_regular_file()) {
+        inputs.push_back(BatchInput{entry.path().string()});
+      }
+    }
+    std::sort(inputs.begin(), inputs.end(),
+              [](const BatchInput &lhs, const BatchInput &rhs) {
+                return lhs.path < rhs.path;
+              });
+    return inputs;
+  }
+  std::ifstream ifs(source);
+  if (!ifs) {
+    throw std::runtime_error("Failed to open " + source + ".");
+  }
+  const fs::path dir = fs::path(source).parent_path();
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream iss(line);
+    std::string first;
+    if (!(iss >> first) || first[0] == '#') {
+      continue;
+    }
+    BatchInput input;
+    std::string path;
+    if (iss >> path) {
+      input.day = std::stoi(first);
+    } else {
+      path = first;
+    }
+    input.path = fs::path(path).is_absolute() ? path : (dir / path).string();
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+// Runs the parts of a task on the current thread. Returns one JSON line per
+// part.
+inline std::string solveBatchTask(const BatchTask &task, bool &ok) {
+  using Clock = std::chrono::steady_clock;
+  inputPath = task.path;
+  std::ostringstream oss;
+  oss << std::setprecision(6);
+  for (const auto &part : *task.parts) {
+    std::string output;
+    std::string error;
+    const auto start = Clock::now();
+    try {
+      ScopedOutput capture(&output, false);
+      const ArenaScope arenaScope;
+      part.func();
+    } catch (const std::exception &e) {
+      error = e.what();
+      ok = false;
+    }
+    const auto end = Clock::now();
+    oss << "{\"input\":\""
+        << jsonEscape(task.label.empty() ? task.path : task.label) << "\"";
+    if (task.day > 0) {
+      oss << ",\"day\":" << task.day;
+    }
+    oss << ",\"part\":\"" << jsonEscape(part.name) << "\",\"ms\":"
+        << std::chrono::duration<double, std::milli>(end - start).count();
+    if (error.empty()) {
+      oss << ",\"answer\":\"" << jsonEscape(summarizeOutput(output))
+          << "\"}\n";
+    } else {
+      oss << ",\"error\":\"" << jsonEscape(error) << "\"}\n";
+    }
+  }
+  return oss.str();
+}
+
+// Solves the tasks on numThreads threads, each grabbing the next task when it
+// is done with one. Returns false if any part failed.
+inline bool runBatch(const std::vector<BatchTask> &tasks,
+                     unsigned int numThreads) {
+  std::atomic<size_t> nextTask{0};
+  std::atomic<bool> ok{true};
+  std::mutex outputMutex;
+  const auto start = std::chrono::steady_clock::now();
+  const auto work = [&]() {
+    for (size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+      bool taskOk = true;
+      const std::string lines = solveBatchTask(tasks[i], taskOk);
+      if (!taskOk) {
+        ok = false;
+      }
+      std::lock_guard<std::mutex> lock(outputMutex);
+      std::cout << lines << std::flush;
+    }
+  };
+  numThreads = std::max(1u, std::min<unsigned int>(numThreads, tasks.size()));
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < numThreads; ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  std::cerr << "Solved " << tasks.size() << " inputs in "
+            << formatDuration(seconds * 1000.0) << " on " << numThreads
+            << (numThreads == 1 ? " thread: " : " threads: ")
+            << std::setprecision(4)
+            << tasks.size() / std::max(seconds, 1e-9) << " inputs/s\n";
+  return ok;
+}
+
+inline bool isBatchMode(int argc, char *argv[]) {
+  return argc > 1 && std::string(argv[1]) == "--batch";
+}
+
+// main() of a day in batch mode: ./solve --batch <dir|manifest> [-j <n>]
+// The days of a manifest are ignored, every input is solved by this day.
+inline int batchMain(int argc, char *argv[],
+                     const std::vector<BatchPart> &parts) {
+  unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<BatchTask> tasks;
+  try {
+    if (argc < 3) {
+      throw std::runtime_error("Missing value for --batch.");
+    }
+    for (int i = 3; i < argc; ++i) {
+      if (std::string(argv[i]) == "-j" && i + 1 < argc) {
+        numThreads = std::max(1, std::atoi(argv[++i]));
+      } else {
+        throw std::runtime_error(std::string("Unknown argument ") + argv[i] +
+                                 ".");
+      }
+    }
+    for (auto &input : loadBatch(argv[2])) {
+      tasks.push_back(BatchTask{std::move(input.path), 0, &parts});
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n"
+              << "Usage: solve --batch <dir|manifest> [-j <threads>]\n";
+    return 1;
+  }
+  return runBatch(tasks, numThreads) ? 0 : 1;
+}
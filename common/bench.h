@@ -0,0 +1,605 @@
+#pragma once
+
+#include "alloc_stats.h"
+#include "arena.h"
+#include "format.h"
+#include "history.h"
+#include "input.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Benchmark harness shared by all days.
+// measureTime() keeps its old signature, so the call sites in the days stay
+// untouched. What it does is configured via environment variables:
+//   AOC_BENCH_WARMUP=<n>       Unmeasured runs before measuring (default 0).
+//   AOC_BENCH_MIN_TIME_MS=<t>  Keep repeating until the measured runs add up
+//                              to at least t ms (default 0, i.e. one run).
+//   AOC_BENCH_MIN_RUNS=<n>     Measure at least n runs (default 1).
+//   AOC_BENCH_MAX_RUNS=<n>     Upper bound for the adaptive repetitions.
+//   AOC_BENCH_OUTPUT=<path>    Append one record per measurement to a file.
+//   AOC_BENCH_FORMAT=json|csv  Record format (default derived from the path).
+//   AOC_BENCH_HISTORY=<path>   Append one record per measurement tagged with
+//                              commit, build variant and CPU (see
+//                              history.h).
+//   AOC_RESULT_CACHE=<path>    Answer parts from this cache of earlier runs
+//                              on the same input and binary, and add the
+//                              ones computed (see result_cache.h).
+//   AOC_BENCH_COUNTERS=1       Read hardware counters around the measured
+//                              runs and report IPC and misses per input byte
+//                              (see perf_counters.h). They only count the
+//                              measuring thread, parts whose thread pool
+//                              tasks ran elsewhere are flagged as partial.
+//   AOC_TRACE=<path>           Write a Chrome trace of the runs (see trace.h).
+// The runner's --profile samples the measured runs (see profiler.h).
+// Each run gets the scratchArena() of arena.h rewound.
+// Building with ALLOC_STATS=1 additionally reports the heap allocations per
+// measured run (see alloc_stats.h), including those of its thread pool tasks
+// (see thread_pool.h).
+// Only the first measured run prints to std::cout. Warmups and repetitions are
+// muted so that the output looks the same no matter how often we repeat.
+
+// Routes the std::cout output of each thread separately. A thread can mute its
+// output or capture it into a string. That way concurrently running solvers
+// don't interleave their output and repetitions can run silently.
+class RoutedStreamBuf : public std::streambuf {
+public:
+  explicit RoutedStreamBuf(std::streambuf *fallback_) : fallback(fallback_) {}
+
+  static inline thread_local std::string *capture = nullptr;
+  static inline thread_local bool mute = false;
+
+protected:
+  int_type overflow(int_type ch) override {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+      return traits_type::not_eof(ch);
+    }
+    const char c = traits_type::to_char_type(ch);
+    return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    if (mute) {
+      return n;
+    }
+    if (capture) {
+      capture->append(s, n);
+      return n;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallback->sputn(s, n);
+  }
+
+  int sync() override {
+    if (mute || capture) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallback->pubsync();
+  }
+
+private:
+  std::streambuf *fallback;
+  std::mutex mutex;
+};
+
+inline void installOutputRouting() {
+  // Leaked on purpose: std::cout is flushed after static destructors ran.
+  static RoutedStreamBuf *routedBuf = [] {
+    auto *buf = new RoutedStreamBuf(std::cout.rdbuf());
+    std::cout.rdbuf(buf);
+    return buf;
+  }();
+  (void)routedBuf;
+}
+
+// Redirects the std::cout output of the current thread for its lifetime.
+// Either mutes it or captures it into the given string. Otherwise the output
+// keeps going wherever it went before.
+class ScopedOutput {
+public:
+  ScopedOutput(std::string *capture, bool mute)
+      : prevCapture(RoutedStreamBuf::capture), prevMute(RoutedStreamBuf::mute) {
+    installOutputRouting();
+    if (mute) {
+      RoutedStreamBuf::mute = true;
+    } else if (capture) {
+      RoutedStreamBuf::capture = capture;
+      RoutedStreamBuf::mute = false;
+    }
+  }
+  ~ScopedOutput() {
+    RoutedStreamBuf::capture = prevCapture;
+    RoutedStreamBuf::mute = prevMute;
+  }
+  ScopedOutput(const ScopedOutput &) = delete;
+  ScopedOutput &operator=(const ScopedOutput &) = delete;
+
+private:
+  std::string *prevCapture;
+  bool prevMute;
+};
+
+enum class BenchFormat { NONE, JSON, CSV };
+
+struct BenchConfig {
+  int warmups = 0;
+  int minRuns = 1;
+  int maxRuns = 1000;
+  double minTimeMs = 0.0;
+  bool counters = false;
+  BenchFormat format = BenchFormat::NONE;
+  std::string outputPath;
+  std::string historyPath;
+  std::string resultCachePath;
+
+  static BenchConfig fromEnv() {
+    BenchConfig config;
+    if (const char *env = std::getenv("AOC_BENCH_WARMUP")) {
+      config.warmups = std::max(0, std::atoi(env));
+    }
+    if (const char *env = std::getenv("AOC_BENCH_MIN_TIME_MS")) {
+      config.minTimeMs = std::max(0.0, std::atof(env));
+    }
+    if (const char *env = std::getenv("AOC_BENCH_MIN_RUNS")) {
+      config.minRuns = std::max(1, std::atoi(env));
+    }
+    if (const char *env = std::getenv("AOC_BENCH_MAX_RUNS")) {
+      config.maxRuns = std::max(1, std::atoi(env));
+    }
+    if (const char *env = std::getenv("AOC_BENCH_COUNTERS")) {
+      config.counters = std::atoi(env) != 0;
+    }
+    if (const char *env = std::getenv("AOC_BENCH_OUTPUT")) {
+      config.setOutput(env, std::getenv("AOC_BENCH_FORMAT"));
+    }
+    if (const char *env = std::getenv("AOC_BENCH_HISTORY")) {
+      config.historyPath = env;
+    }
+    if (const char *env = std::getenv("AOC_RESULT_CACHE")) {
+      config.resultCachePath = env;
+    }
+    return config;
+  }
+
+  void setOutput(const std::string &path, const char *formatName = nullptr) {
+    outputPath = path;
+    const std::string name =
+        formatName ? formatName : std::filesystem::path(path).extension();
+    format = (name == "csv" || name == ".csv") ? BenchFormat::CSV
+                                               : BenchFormat::JSON;
+  }
+};
+
+// Process wide config. Initialized from the environment, the runner overrides
+// it with its command line options.
+inline BenchConfig &benchConfig() {
+  static BenchConfig config = BenchConfig::fromEnv();
+  return config;
+}
+
+struct BenchStats {
+  std::string group; // E.g. the day.
+  std::string name;  // E.g. the part.
+  int warmups = 0;
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double p90Ms = 0.0;
+  double p99Ms = 0.0;
+  double maxMs = 0.0;
+  double meanMs = 0.0;
+  double stddevMs = 0.0;
+  // Averaged over the measured runs. Only read if enabled in the config.
+  PerfCounts counters;
+  size_t inputBytes = 0;
+  // Tasks of the thread pool ran on other threads, which the counters missed.
+  bool countersPartial = false;
+  // Averaged over the measured runs, the peak is the maximum. Only counted if
+  // allocStatsEnabled.
+  double allocs = 0.0;
+  double allocBytes = 0.0;
+  long long peakLiveBytes = 0;
+  // Output of the first measured run. Only filled in while collecting or
+  // caching results.
+  std::string output;
+  // Answered from the result cache. The times are the ones of the run that
+  // computed it.
+  bool cached = false;
+};
+
+// Group name put into the stats of the current thread. Defaults to the name of
+// the working directory, i.e. the day.
+inline thread_local std::string benchGroup =
+    std::filesystem::current_path().filename().string();
+
+// If set, measureTime() appends the stats of the current thread here.
+inline thread_local std::vector<BenchStats> *benchCollector = nullptr;
+
+// Linear interpolation between the closest ranks of the sorted samples.
+inline double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const double rank = p / 100.0 * (sorted.size() - 1);
+  const size_t lower = static_cast<size_t>(rank);
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+inline void computeStats(std::vector<double> samplesMs, BenchStats &stats) {
+  std::sort(samplesMs.begin(), samplesMs.end());
+  stats.runs = static_cast<int>(samplesMs.size());
+  if (samplesMs.empty()) {
+    return;
+  }
+  stats.minMs = samplesMs.front();
+  stats.maxMs = samplesMs.back();
+  stats.medianMs = percentile(samplesMs, 50.0);
+  stats.p90Ms = percentile(samplesMs, 90.0);
+  stats.p99Ms = percentile(samplesMs, 99.0);
+  double sum = 0.0;
+  for (const double sample : samplesMs) {
+    sum += sample;
+  }
+  stats.meanMs = sum / samplesMs.size();
+  double sqSum = 0.0;
+  for (const double sample : samplesMs) {
+    sqSum += (sample - stats.meanMs) * (sample - stats.meanMs);
+  }
+  stats.stddevMs =
+      samplesMs.size() > 1 ? std::sqrt(sqSum / (samplesMs.size() - 1)) : 0.0;
+}
+
+// Opens the counters if enabled. Tells once if they aren't available.
+inline std::unique_ptr<PerfCounters>
+openPerfCounters(const BenchConfig &config) {
+  if (!config.counters) {
+    return nullptr;
+  }
+  auto counters = std::make_unique<PerfCounters>();
+  if (!counters->available()) {
+    static std::atomic<bool> warned{false};
+    if (!warned.exchange(true)) {
+      std::cerr << "Hardware counters unavailable: " << counters->lastError()
+                << "\n";
+    }
+    return nullptr;
+  }
+  return counters;
+}
+
+template <typename Func>
+BenchStats benchmark(Func &func, const std::string &name,
+                     const BenchConfig &config) {
+  using Clock = std::chrono::steady_clock;
+  BenchStats stats;
+  stats.group = benchGroup;
+  stats.name = name;
+  stats.warmups = config.warmups;
+  {
+    ScopedOutput muted(nullptr, true);
+    for (int i = 0; i < config.warmups; ++i) {
+      ScopedTimer timer(name, "warmup");
+      const ArenaScope arenaScope;
+      func();
+    }
+  }
+  const auto counters = openPerfCounters(config);
+  std::vector<double> samplesMs;
+  double totalMs = 0.0;
+  AllocCounters allocTotals;
+  const size_t offloadedBefore = ThreadPool::tasksOnOtherThreads();
+  while (samplesMs.empty() ||
+         (static_cast<int>(samplesMs.size()) < config.maxRuns &&
+          (static_cast<int>(samplesMs.size()) < config.minRuns ||
+           totalMs < config.minTimeMs))) {
+    // Only the first run may print.
+    const bool first = samplesMs.empty();
+    const bool capture = benchCollector || !config.resultCachePath.empty();
+    ScopedOutput output(first && capture ? &stats.output : nullptr, !first);
+    ScopedTimer timer(name, "part");
+    const ProfileScope profileScope(benchGroup);
+    // Frees the scratch memory of the run.
+    const ArenaScope arenaScope;
+    if (counters) {
+      counters->start();
+    }
+    const AllocScope allocScope;
+    const auto start = Clock::now();
+    func();
+    const auto end = Clock::now();
+    const AllocCounters allocs = allocScope.finish();
+    if (counters) {
+      counters->stop();
+    }
+    allocTotals.allocs += allocs.allocs;
+    allocTotals.bytes += allocs.bytes;
+    allocTotals.peakLiveBytes =
+        std::max(allocTotals.peakLiveBytes, allocs.peakLiveBytes);
+    const double ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    samplesMs.push_back(ms);
+    totalMs += ms;
+  }
+  if (!stats.output.empty()) {
+    std::cout << stats.output;
+  }
+  stats.allocs = static_cast<double>(allocTotals.allocs) / samplesMs.size();
+  stats.allocBytes = static_cast<double>(allocTotals.bytes) / samplesMs.size();
+  stats.peakLiveBytes = allocTotals.peakLiveBytes;
+  computeStats(std::move(samplesMs), stats);
+  if (counters) {
+    stats.counters = counters->counts();
+    stats.countersPartial =
+        ThreadPool::tasksOnOtherThreads() > offloadedBefore;
+    std::error_code ec;
+    stats.inputBytes = std::filesystem::file_size(inputPath, ec);
+    if (ec) {
+      stats.inputBytes = 0;
+    }
+  }
+  return stats;
+}
+
+// Counts per byte of the input, negative if unknown.
+inline double perInputByte(const BenchStats &stats, PerfEvent event) {
+  return stats.counters.has(event) && stats.inputBytes > 0
+             ? stats.counters[event] / stats.inputBytes
+             : -1.0;
+}
+
+inline void writeBenchRecord(const BenchStats &stats,
+                             const BenchConfig &config) {
+  if (config.format == BenchFormat::NONE || config.outputPath.empty()) {
+    return;
+  }
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  const bool isNew = !std::filesystem::exists(config.outputPath) ||
+                     std::filesystem::file_size(config.outputPath) == 0;
+  std::ofstream ofs(config.outputPath, std::ios::app);
+  ofs << std::setprecision(9);
+  if (config.format == BenchFormat::JSON) {
+    ofs << "{\"group\":\"" << jsonEscape(stats.group) << "\",\"name\":\""
+        << jsonEscape(stats.name) << "\",\"warmups\":" << stats.warmups
+        << ",\"runs\":" << stats.runs << ",\"min_ms\":" << stats.minMs
+        << ",\"median_ms\":" << stats.medianMs << ",\"p90_ms\":" << stats.p90Ms
+        << ",\"p99_ms\":" << stats.p99Ms << ",\"max_ms\":" << stats.maxMs
+        << ",\"mean_ms\":" << stats.meanMs << ",\"stddev_ms\":"
+        << stats.stddevMs;
+    if (allocStatsEnabled) {
+      ofs << ",\"allocs\":" << stats.allocs
+          << ",\"alloc_bytes\":" << stats.allocBytes
+          << ",\"peak_live_bytes\":" << stats.peakLiveBytes;
+    }
+    if (config.counters) {
+      // Unavailable counters are null.
+      ofs << ",\"input_bytes\":" << stats.inputBytes;
+      for (size_t i = 0; i < numPerfEvents; ++i) {
+        ofs << ",\"" << perfEventName(i) << "\":";
+        if (stats.counters.values[i] >= 0.0) {
+          ofs << stats.counters.values[i];
+        } else {
+          ofs << "null";
+        }
+      }
+      ofs << ",\"counters_partial\":"
+          << (stats.countersPartial ? "true" : "false");
+    }
+    ofs << "}\n";
+  } else {
+    if (isNew) {
+      ofs << "group,name,warmups,runs,min_ms,median_ms,p90_ms,p99_ms,max_ms,"
+             "mean_ms,stddev_ms";
+      if (allocStatsEnabled) {
+        ofs << ",allocs,alloc_bytes,peak_live_bytes";
+      }
+      if (config.counters) {
+        ofs << ",input_bytes";
+        for (size_t i = 0; i < numPerfEvents; ++i) {
+          ofs << "," << perfEventName(i);
+        }
+        ofs << ",counters_partial";
+      }
+      ofs << "\n";
+    }
+    ofs << csvEscape(stats.group) << "," << csvEscape(stats.name) << ","
+        << stats.warmups << "," << stats.runs << "," << stats.minMs << ","
+        << stats.medianMs << "," << stats.p90Ms << "," << stats.p99Ms << ","
+        << stats.maxMs << "," << stats.meanMs << "," << stats.stddevMs;
+    if (allocStatsEnabled) {
+      ofs << "," << stats.allocs << "," << stats.allocBytes << ","
+          << stats.peakLiveBytes;
+    }
+    if (config.counters) {
+      // Unavailable counters are empty.
+      ofs << "," << stats.inputBytes;
+      for (size_t i = 0; i < numPerfEvents; ++i) {
+        ofs << ",";
+        if (stats.counters.values[i] >= 0.0) {
+          ofs << stats.counters.values[i];
+        }
+      }
+      ofs << "," << (stats.countersPartial ? 1 : 0);
+    }
+    ofs << "\n";
+  }
+}
+
+inline void writeHistoryRecord(const BenchStats &stats,
+                               const BenchConfig &config) {
+  if (config.historyPath.empty()) {
+    return;
+  }
+  const BenchEnvironment &env = benchEnvironment();
+  HistoryRecord record;
+  record.time = currentTime();
+  record.commit = env.commit;
+  record.build = env.build;
+  record.cpu = env.cpu;
+  record.group = stats.group;
+  record.name = stats.name;
+  record.runs = stats.runs;
+  record.minMs = stats.minMs;
+  record.medianMs = stats.medianMs;
+  record.meanMs = stats.meanMs;
+  record.stddevMs = stats.stddevMs;
+  appendHistory(config.historyPath, record);
+}
+
+// E.g. "1000 allocations (1.2 MiB), peak live 64 KiB".
+inline std::string formatAllocs(const BenchStats &stats) {
+  std::ostringstream oss;
+  oss << std::setprecision(6) << stats.allocs << " allocations ("
+      << formatBytes(stats.allocBytes) << "), peak live "
+      << formatBytes(static_cast<double>(stats.peakLiveBytes));
+  return oss.str();
+}
+
+// E.g. "IPC 2.31, per input byte: 310 cycles, 1.2 L1D misses, ...".
+inline std::string formatCounters(const BenchStats &stats) {
+  std::ostringstream oss;
+  oss << std::setprecision(3);
+  const double ipc = stats.counters.ipc();
+  if (ipc >= 0.0) {
+    oss << "IPC " << ipc;
+  } else {
+    oss << "IPC n/a";
+  }
+  static const std::pair<PerfEvent, const char *> perByte[] = {
+      {PerfEvent::CYCLES, "cycles"},
+      {PerfEvent::L1D_MISSES, "L1D misses"},
+      {PerfEvent::LLC_MISSES, "LLC misses"},
+      {PerfEvent::BRANCH_MISSES, "branch misses"},
+      {PerfEvent::DTLB_MISSES, "dTLB misses"},
+  };
+  const char *sep = ", per input byte: ";
+  for (const auto &[event, name] : perByte) {
+    const double value = perInputByte(stats, event);
+    if (value >= 0.0) {
+      oss << sep << value << " " << name;
+      sep = ", ";
+    }
+  }
+  if (stats.countersPartial) {
+    oss << " (partial: this thread only, pool workers ran some of the work)";
+  }
+  return oss.str();
+}
+
+inline void reportBenchStats(const BenchStats &stats,
+                             const BenchConfig &config) {
+  std::ostringstream oss;
+  if (stats.cached) {
+    // Nothing was measured, so there are no records either.
+    oss << stats.name << " answered from the result cache (computing it took "
+        << formatDuration(stats.medianMs) << ")\n";
+    std::cout << oss.str();
+    return;
+  }
+  oss << stats.name << " took " << formatDuration(stats.medianMs);
+  if (stats.runs > 1) {
+    oss << " (median of " << stats.runs << " runs, min "
+        << formatDuration(stats.minMs) << ", p90 "
+        << formatDuration(stats.p90Ms) << ", p99 "
+        << formatDuration(stats.p99Ms) << ", stddev "
+        << formatDuration(stats.stddevMs) << ")";
+  }
+  oss << "\n";
+  if (allocStatsEnabled) {
+    oss << "  " << formatAllocs(stats) << "\n";
+  }
+  if (stats.counters.any()) {
+    oss << "  " << formatCounters(stats) << "\n";
+  }
+  std::cout << oss.str();
+  writeBenchRecord(stats, config);
+  writeHistoryRecord(stats, config);
+}
+
+// Stats of a part answered from the result cache, if it is enabled and has
+// the part. Prints the stored output.
+inline std::optional<BenchStats> lookupResult(const std::string &name,
+                                              const BenchConfig &config) {
+  if (config.resultCachePath.empty()) {
+    return std::nullopt;
+  }
+  const auto key = resultKey(benchGroup, name);
+  if (!key) {
+    return std::nullopt;
+  }
+  const auto result = resultCache(config.resultCachePath).find(*key);
+  if (!result) {
+    return std::nullopt;
+  }
+  BenchStats stats;
+  stats.group = benchGroup;
+  stats.name = name;
+  stats.cached = true;
+  stats.runs = result->runs;
+  stats.minMs = result->minMs;
+  stats.medianMs = result->medianMs;
+  stats.meanMs = result->meanMs;
+  stats.output = result->output;
+  std::cout << stats.output;
+  return stats;
+}
+
+inline void storeResult(const BenchStats &stats, const BenchConfig &config) {
+  if (config.resultCachePath.empty()) {
+    return;
+  }
+  if (const auto key = resultKey(stats.group, stats.name)) {
+    CachedResult result;
+    result.time = currentTime();
+    result.runs = stats.runs;
+    result.minMs = stats.minMs;
+    result.medianMs = stats.medianMs;
+    result.meanMs = stats.meanMs;
+    result.output = stats.output;
+    resultCache(config.resultCachePath).store(*key, result);
+  }
+}
+
+// The explicit number of repetitions is a lower bound for the measured runs.
+template <typename Func>
+void measureTime(Func func, const std::string &name, int repetitions = 1) {
+  BenchConfig config = benchConfig();
+  config.minRuns = std::max(config.minRuns, repetitions);
+  config.maxRuns = std::max(config.maxRuns, config.minRuns);
+  if (inputIsStdin()) {
+    // Repetitions would find stdin empty.
+    config.warmups = 0;
+    config.minRuns = config.maxRuns = 1;
+    config.minTimeMs = 0.0;
+  }
+  std::cout << "Running " << name << "...\n";
+  auto stats = lookupResult(name, config);
+  if (!stats) {
+    stats = benchmark(func, name, config);
+    storeResult(*stats, config);
+  }
+  reportBenchStats(*stats, config);
+  if (benchCollector) {
+    benchCollector->push_back(*stats);
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+// Embedded input: make EMBED=1 builds solve-embed with the day's input.txt
+// compiled in as embeddedInput (via ../scripts/embed_input.sh). Days that
+// support it compute their answers from it at compile time, so the binary
+// only prints them and its measured time is what's left besides the
+// computation, e.g.
+//   #ifdef AOC_EMBED_INPUT
+//     constexpr auto sum = sumOfHashes(embeddedInput);
+//   #endif
+// A path on the command line is ignored by those parts.
+// The helpers below are constexpr replacements for what the days use at
+// runtime (C++17 has no constexpr std::sort).
+
+#ifdef AOC_EMBED_INPUT
+#include "input_embed.h"
+
+constexpr std::string_view embeddedInput(embeddedInputData,
+                                         sizeof(embeddedInputData) - 1);
+#endif
+
+// Calls func for each record of data separated by delim. Like LineReader, a
+// trailing separator doesn't produce an empty last record.
+template <typename Func>
+constexpr void forEachRecord(std::string_view data, char delim, Func func) {
+  while (!data.empty()) {
+    const size_t end = data.find(delim);
+    func(data.substr(0, end));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    data.remove_prefix(end + 1);
+  }
+}
+
+constexpr size_t countRecords(std::string_view data, char delim) {
+  size_t count = 0;
+  forEachRecord(data, delim, [&](std::string_view) { ++count; });
+  return count;
+}
+
+// Heap sort, O(n log n) without recursion or allocations.
+template <typename It, typename Less>
+constexpr void constexprSort(It first, It last, Less less) {
+  const auto n = last - first;
+  const auto siftDown = [&](auto root, auto size) {
+    while (2 * root + 1 < size) {
+      auto child = 2 * root + 1;
+      if (child + 1 < size && less(first[child], first[child + 1])) {
+        ++child;
+      }
+      if (!less(first[root], first[child])) {
+        return;
+      }
+      auto tmp = std::move(first[root]);
+      first[root] = std::move(first[child]);
+      first[child] = std::move(tmp);
+      root = child;
+    }
+  };
+  for (auto root = n / 2; root-- > 0;) {
+    siftDown(root, n);
+  }
+  for (auto end = n; end-- > 1;) {
+    auto tmp = std::move(first[0]);
+    first[0] = std::move(first[end]);
+    first[end] = std::move(tmp);
+    siftDown(decltype(n)(0), end);
+  }
+}
+
+template <typename It> constexpr void constexprSort(It first, It last) {
+  constexprSort(first, last,
+                [](const auto &lhs, const auto &rhs) { return lhs < rhs; });
+}
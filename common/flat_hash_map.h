@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Open addressing hash map with linear probing. The entries live in one
+// array, so a lookup usually touches a single cache line instead of chasing
+// the node pointers of std::unordered_map. A control byte per slot holds 7
+// bits of the hash, so most mismatching slots are skipped without comparing
+// keys. Erasing shifts the following entries back, so there are no
+// tombstones.
+// Lookups are heterogeneous: A map with std::string keys can be searched with
+// a std::string_view. Pointers to values stay valid until the map grows.
+// The slots are allocated by Alloc, e.g. a std::pmr::polymorphic_allocator
+// taking them from scratchArena(), but constructed by the map itself.
+
+// Hash with well mixed low bits, the map uses them as index. Strings of all
+// kinds hash the same.
+template <typename Key, typename = void> struct FlatHash {
+  size_t operator()(const Key &key) const { return mix(std::hash<Key>()(key)); }
+
+  static size_t mix(uint64_t x) {
+    // Finalizer of splitmix64.
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_t>(x ^ (x >> 31));
+  }
+};
+
+template <typename Key>
+inline constexpr bool isStringLike =
+    std::is_convertible_v<const Key &, std::string_view>;
+
+template <typename Key>
+struct FlatHash<Key, std::enable_if_t<isStringLike<Key>>> {
+  size_t operator()(std::string_view key) const {
+    return std::hash<std::string_view>()(key);
+  }
+};
+
+template <typename Key, typename Value, typename Hash = FlatHash<Key>,
+          typename Equal = std::equal_to<>,
+          typename Alloc = std::allocator<char>>
+class FlatHashMap {
+public:
+  struct Entry {
+    Key key;
+    Value value;
+  };
+
+  explicit FlatHashMap(const Alloc &alloc_ = Alloc()) : alloc(alloc_) {}
+
+  ~FlatHashMap() { release(); }
+
+  FlatHashMap(const FlatHashMap &) = delete;
+  FlatHashMap &operator=(const FlatHashMap &) = delete;
+
+  FlatHashMap(FlatHashMap &&other) noexcept
+      : alloc(other.alloc), ctrl(std::exchange(other.ctrl, nullptr)),
+        entries(std::exchange(other.entries, nullptr)),
+        numSlots(std::exchange(other.numSlots, 0)),
+        numEntries(std::exchange(other.numEntries, 0)) {}
+
+  FlatHashMap &operator=(FlatHashMap &&other) noexcept {
+    if (this != &other) {
+      release();
+      alloc = other.alloc;
+      ctrl = std::exchange(other.ctrl, nullptr);
+      entries = std::exchange(other.entries, nullptr);
+      numSlots = std::exchange(other.numSlots, 0);
+      numEntries = std::exchange(other.numEntries, 0);
+    }
+    return *this;
+  }
+
+  size_t size() const { return numEntries; }
+  bool empty() const { return numEntries == 0; }
+  size_t capacity() const { return numSlots; }
+
+  // Makes room for n entries without growing in between.
+  void reserve(size_t n) {
+    size_t slots = 16;
+    while (!fits(n, slots)) {
+      slots *= 2;
+    }
+    if (slots > numSlots) {
+      rehash(slots);
+    }
+  }
+
+  // Removes all entries but keeps the slots.
+  void clear() {
+    for (size_t i = 0; i < numSlots; ++i) {
+      if (ctrl[i] != EMPTY) {
+        entries[i].~Entry();
+      }
+    }
+    if (numSlots > 0) {
+      std::memset(ctrl, EMPTY, numSlots);
+    }
+    numEntries = 0;
+  }
+
+  template <typename K> Value *find(const K &key) {
+    const size_t slot = findSlot(key);
+    return slot != npos ? &entries[slot].value : nullptr;
+  }
+  template <typename K> const Value *find(const K &key) const {
+    const size_t slot = findSlot(key);
+    return slot != npos ? &entries[slot].value : nullptr;
+  }
+  template <typename K> bool contains(const K &key) const {
+    return findSlot(key) != npos;
+  }
+
+  // Inserts Value(args...) unless the key is present. Returns the value of
+  // the key and whether it was inserted. A single probe finds the key or the
+  // slot to insert it in, only a full table probes again after growing.
+  template <typename K, typename... Args>
+  std::pair<Value *, bool> tryEmplace(const K &key, Args &&...args) {
+    if (numSlots == 0) {
+      rehash(16);
+    }
+    const size_t hash = Hash()(key);
+    const uint8_t tag = tagOf(hash);
+    size_t i = hash & mask();
+    for (; ctrl[i] != EMPTY; i = (i + 1) & mask()) {
+      if (ctrl[i] == tag && Equal()(entries[i].key, key)) {
+        return {&entries[i].value, false};
+      }
+    }
+    if (!fits(numEntries + 1, numSlots)) {
+      rehash(numSlots * 2);
+      i = hash & mask();
+      while (ctrl[i] != EMPTY) {
+        i = (i + 1) & mask();
+      }
+    }
+    new (&entries[i]) Entry{Key(key), Value(std::forward<Args>(args)...)};
+    ctrl[i] = tag;
+    ++numEntries;
+    return {&entries[i].value, true};
+  }
+
+  template <typename K> Value &operator[](const K &key) {
+    return *tryEmplace(key).first;
+  }
+
+  template <typename K> bool erase(const K &key) {
+    size_t hole = findSlot(key);
+    if (hole == npos) {
+      return false;
+    }
+    entries[hole].~Entry();
+    ctrl[hole] = EMPTY;
+    --numEntries;
+    // Move later entries of the probe sequence into the hole if their home
+    // slot isn't between the hole and them.
+    for (size_t i = (hole + 1) & mask(); ctrl[i] != EMPTY;
+         i = (i + 1) & mask()) {
+      const size_t home = Hash()(entries[i].key) & mask();
+      if (((i - home) & mask()) >= ((i - hole) & mask())) {
+        new (&entries[hole]) Entry(std::move(entries[i]));
+        ctrl[hole] = ctrl[i];
+        entries[i].~Entry();
+        ctrl[i] = EMPTY;
+        hole = i;
+      }
+    }
+    return true;
+  }
+
+  // Calls func(key, value) for each entry in no particular order.
+  template <typename Func> void forEach(Func func) const {
+    for (size_t i = 0; i < numSlots; ++i) {
+      if (ctrl[i] != EMPTY) {
+        func(entries[i].key, entries[i].value);
+      }
+    }
+  }
+
+private:
+  using CtrlAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+  using EntryAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<Entry>;
+
+  static constexpr uint8_t EMPTY = 0;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // At most 7/8 full. Linear probing gets slow beyond that.
+  static bool fits(size_t n, size_t slots) { return n * 8 <= slots * 7; }
+  // The high bit marks the slot as used, the other bits are from the hash.
+  static uint8_t tagOf(size_t hash) {
+    return static_cast<uint8_t>(0x80 | (hash >> (sizeof(size_t) * 8 - 7)));
+  }
+  size_t mask() const { return numSlots - 1; }
+
+  template <typename K> size_t findSlot(const K &key) const {
+    if (numEntries == 0) {
+      return npos;
+    }
+    const size_t hash = Hash()(key);
+    const uint8_t tag = tagOf(hash);
+    for (size_t i = hash & mask(); ctrl[i] != EMPTY; i = (i + 1) & mask()) {
+      if (ctrl[i] == tag && Equal()(entries[i].key, key)) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  void rehash(size_t slots) {
+    uint8_t *oldCtrl = ctrl;
+    Entry *oldEntries = entries;
+    const size_t oldSlots = numSlots;
+    CtrlAlloc ctrlAlloc(alloc);
+    EntryAlloc entryAlloc(alloc);
+    ctrl = std::allocator_traits<CtrlAlloc>::allocate(ctrlAlloc, slots);
+    entries = std::allocator_traits<EntryAlloc>::allocate(entryAlloc, slots);
+    std::memset(ctrl, EMPTY, slots);
+    numSlots = slots;
+    for (size_t i = 0; i < oldSlots; ++i) {
+      if (oldCtrl[i] == EMPTY) {
+        continue;
+      }
+      size_t j = Hash()(oldEntries[i].key) & mask();
+      while (ctrl[j] != EMPTY) {
+        j = (j + 1) & mask();
+      }
+      new (&entries[j]) Entry(std::move(oldEntries[i]));
+      ctrl[j] = oldCtrl[i];
+      oldEntries[i].~Entry();
+    }
+    if (oldSlots > 0) {
+      std::allocator_traits<CtrlAlloc>::deallocate(ctrlAlloc, oldCtrl,
+                                                   oldSlots);
+      std::allocator_traits<EntryAlloc>::deallocate(entryAlloc, oldEntries,
+                                                    oldSlots);
+    }
+  }
+
+  void release() {
+    if (numSlots == 0) {
+      return;
+    }
+    clear();
+    CtrlAlloc ctrlAlloc(alloc);
+    EntryAlloc entryAlloc(alloc);
+    std::allocator_traits<CtrlAlloc>::deallocate(ctrlAlloc, ctrl, numSlots);
+    std::allocator_traits<EntryAlloc>::deallocate(entryAlloc, entries,
+                                                  numSlots);
+    ctrl = nullptr;
+    entries = nullptr;
+    numSlots = 0;
+  }
+
+  Alloc alloc;
+  uint8_t *ctrl = nullptr;
+  Entry *entries = nullptr;
+  size_t numSlots = 0;
+  size_t numEntries = 0;
+};
+
+// Set on top of the map, see FlatHashMap.
+template <typename Key, typename Hash = FlatHash<Key>,
+          typename Equal = std::equal_to<>,
+          typename Alloc = std::allocator<char>>
+class FlatHashSet {
+public:
+  explicit FlatHashSet(const Alloc &alloc = Alloc()) : map(alloc) {}
+
+  size_t size() const { return map.size(); }
+  bool empty() const { return map.empty(); }
+  void reserve(size_t n) { map.reserve(n); }
+  void clear() { map.clear(); }
+
+  // Returns whether the key was inserted, i.e. wasn't present yet.
+  template <typename K> bool insert(const K &key) {
+    return map.tryEmplace(key).second;
+  }
+  template <typename K> bool contains(const K &key) const {
+    return map.contains(key);
+  }
+  template <typename K> bool erase(const K &key) { return map.erase(key); }
+
+  template <typename Func> void forEach(Func func) const {
+    map.forEach([&](const Key &key, const Empty &) { func(key); });
+  }
+
+private:
+  struct Empty {};
+  FlatHashMap<Key, Empty, Hash, Equal, Alloc> map;
+};
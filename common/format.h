@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Formatting helpers for the reports and records of the benchmarks.
+
+// Prints a duration in readable form.
+inline std::string formatDuration(double ms) {
+  std::ostringstream oss;
+  oss << std::setprecision(6);
+  if (ms >= 10000.0) {
+    oss << ms / 1000.0 << " s";
+  } else if (ms < 0.001) {
+    oss << std::round(ms * 1000000.0) << " ns";
+  } else if (ms < 10.0) {
+    // Microsecond resolution.
+    oss << std::round(ms * 1000.0) / 1000.0 << " ms";
+  } else {
+    oss << std::round(ms) << " ms";
+  }
+  return oss.str();
+}
+
+// Byte counts with binary prefixes.
+inline std::string formatBytes(double bytes) {
+  static const char *const units[] = {"B", "KiB", "MiB", "GiB"};
+  size_t unit = 0;
+  while (std::abs(bytes) >= 1024.0 && unit + 1 < std::size(units)) {
+    bytes /= 1024.0;
+    ++unit;
+  }
+  std::ostringstream oss;
+  oss << std::setprecision(unit == 0 ? 6 : 3) << bytes << " " << units[unit];
+  return oss.str();
+}
+
+inline std::string jsonEscape(const std::string &str) {
+  std::string ret;
+  ret.reserve(str.size());
+  for (const char ch : str) {
+    if (ch == '"' || ch == '\\') {
+      ret += '\\';
+      ret += ch;
+    } else if (ch == '\n') {
+      ret += "\\n";
+    } else if (static_cast<unsigned char>(ch) < 0x20) {
+      ret += ' ';
+    } else {
+      ret += ch;
+    }
+  }
+  return ret;
+}
+
+inline std::string csvEscape(const std::string &str) {
+  if (str.find_first_of(",\"\n") == std::string::npos) {
+    return str;
+  }
+  std::string ret = "\"";
+  for (const char ch : str) {
+    if (ch == '"') {
+      ret += '"';
+    }
+    ret += ch;
+  }
+  return ret + "\"";
+}
+
+// The answers are usually the last lines a part printed. Parts solving both
+// puzzles print two of them.
+inline std::string summarizeOutput(const std::string &output) {
+  std::vector<std::string> lines;
+  std::istringstream iss(output);
+  std::string line;
+  while (std::getline(iss, line)) {
+    if (!line.empty()) {
+      lines.push_back(line);
+    }
+  }
+  if (lines.empty()) {
+    return "";
+  }
+  if (lines.size() == 2) {
+    return lines[0] + " | " + lines[1];
+  }
+  return lines.back();
+}
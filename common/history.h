@@ -0,0 +1,194 @@
+#pragma once
+
+#include "format.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <limits.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Benchmark history: One JSON line per measured part, tagged with the commit,
+// the build variant and the CPU, so timings of different runs can be compared
+// later (see the runner's --baseline).
+
+// The day Makefiles define AOC_BUILD as the BUILD variant.
+#ifdef AOC_BUILD
+inline constexpr const char *buildVariant = AOC_BUILD;
+#elif defined(__OPTIMIZE__)
+inline constexpr const char *buildVariant = "optimized";
+#else
+inline constexpr const char *buildVariant = "debug";
+#endif
+
+struct BenchEnvironment {
+  std::string commit;
+  std::string build;
+  std::string cpu;
+};
+
+// First line of the output of a shell command, empty if it failed.
+inline std::string commandOutput(const std::string &command) {
+  std::string ret;
+  if (FILE *pipe = ::popen(command.c_str(), "r")) {
+    char buf[256];
+    if (std::fgets(buf, sizeof(buf), pipe)) {
+      ret = buf;
+    }
+    if (::pclose(pipe) != 0) {
+      ret.clear();
+    }
+  }
+  while (!ret.empty() && (ret.back() == '\n' || ret.back() == '\r')) {
+    ret.pop_back();
+  }
+  return ret;
+}
+
+// Commit of the checkout the binary was built in. AOC_COMMIT overrides it.
+// Uncommitted changes are marked with "-dirty".
+inline std::string detectCommit() {
+  if (const char *env = std::getenv("AOC_COMMIT")) {
+    return env;
+  }
+  char exe[PATH_MAX];
+  const ssize_t len = ::readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  std::string dir = ".";
+  if (len > 0) {
+    dir.assign(exe, len);
+    dir = dir.substr(0, dir.rfind('/'));
+  }
+  const std::string git = "git -C '" + dir + "' ";
+  std::string commit =
+      commandOutput(git + "rev-parse --short=12 HEAD 2>/dev/null");
+  if (commit.empty()) {
+    return "unknown";
+  }
+  if (::system((git + "diff --quiet HEAD 2>/dev/null").c_str()) != 0) {
+    commit += "-dirty";
+  }
+  return commit;
+}
+
+inline std::string detectCpu() {
+  std::ifstream ifs("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      const auto pos = line.find(':');
+      if (pos != std::string::npos && pos + 2 <= line.size()) {
+        return line.substr(pos + 2);
+      }
+    }
+  }
+  return "unknown";
+}
+
+// Detected once per process.
+inline const BenchEnvironment &benchEnvironment() {
+  static const BenchEnvironment env{detectCommit(), buildVariant,
+                                    detectCpu()};
+  return env;
+}
+
+struct HistoryRecord {
+  std::string time; // UTC, ISO 8601.
+  std::string commit;
+  std::string build;
+  std::string cpu;
+  std::string group;
+  std::string name;
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  double stddevMs = 0.0;
+};
+
+inline std::string currentTime() {
+  const std::time_t now = std::time(nullptr);
+  std::tm tm;
+  ::gmtime_r(&now, &tm);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  return buf;
+}
+
+inline void appendHistory(const std::string &path,
+                          const HistoryRecord &record) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::ofstream ofs(path, std::ios::app);
+  ofs << std::setprecision(9) << "{\"time\":\"" << jsonEscape(record.time)
+      << "\",\"commit\":\"" << jsonEscape(record.commit)
+      << "\",\"build\":\"" << jsonEscape(record.build) << "\",\"cpu\":\""
+      << jsonEscape(record.cpu) << "\",\"group\":\""
+      << jsonEscape(record.group) << "\",\"name\":\""
+      << jsonEscape(record.name) << "\",\"runs\":" << record.runs
+      << ",\"min_ms\":" << record.minMs << ",\"median_ms\":"
+      << record.medianMs << ",\"mean_ms\":" << record.meanMs
+      << ",\"stddev_ms\":" << record.stddevMs << "}\n";
+}
+
+// Value of a key in a flat JSON object as written by appendHistory(). Strings
+// are unescaped. Empty if the key is missing.
+inline std::string jsonField(const std::string &line, const std::string &key) {
+  const std::string pattern = "\"" + key + "\":";
+  auto pos = line.find(pattern);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos += pattern.size();
+  std::string ret;
+  if (pos < line.size() && line[pos] == '"') {
+    for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+      if (line[pos] == '\\' && pos + 1 < line.size()) {
+        ++pos;
+        ret += line[pos] == 'n' ? '\n' : line[pos];
+      } else {
+        ret += line[pos];
+      }
+    }
+  } else {
+    const auto end = line.find_first_of(",}", pos);
+    ret = line.substr(pos, end - pos);
+  }
+  return ret;
+}
+
+inline std::vector<HistoryRecord> loadHistory(const std::string &path) {
+  std::ifstream ifs(path);
+  if (!ifs) {
+    throw std::runtime_error("Failed to open " + path + ".");
+  }
+  std::vector<HistoryRecord> ret;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    HistoryRecord record;
+    record.time = jsonField(line, "time");
+    record.commit = jsonField(line, "commit");
+    record.build = jsonField(line, "build");
+    record.cpu = jsonField(line, "cpu");
+    record.group = jsonField(line, "group");
+    record.name = jsonField(line, "name");
+    try {
+      record.runs = std::stoi(jsonField(line, "runs"));
+      record.minMs = std::stod(jsonField(line, "min_ms"));
+      record.medianMs = std::stod(jsonField(line, "median_ms"));
+      record.meanMs = std::stod(jsonField(line, "mean_ms"));
+      record.stddevMs = std::stod(jsonField(line, "stddev_ms"));
+    } catch (const std::exception &) {
+      throw std::runtime_error("Malformed record in " + path + ": " + line);
+    }
+    ret.push_back(std::move(record));
+  }
+  return ret;
+}
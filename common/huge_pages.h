@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+
+// Memory backed by 2 MiB pages, so large state arrays need a fraction of the
+// TLB entries of 4 KiB pages. The arena (arena.h) takes its large chunks from
+// here if AOC_HUGE_PAGES is set:
+//   AOC_HUGE_PAGES=thp      Transparent huge pages (madvise(MADV_HUGEPAGE)).
+//   AOC_HUGE_PAGES=hugetlb  Pages of the hugetlbfs pool (MAP_HUGETLB, see
+//                           /proc/sys/vm/nr_hugepages). Falls back to thp if
+//                           the pool is empty.
+// The pages are faulted in at allocation, so the page faults are paid when the
+// arena grows and not in the measured runs that reuse the chunk.
+// scripts/huge_pages_report.sh compares the dTLB misses of the modes.
+
+enum class HugePageMode { off, thp, hugetlb };
+
+inline constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+inline HugePageMode hugePageMode() {
+  static const HugePageMode mode = [] {
+    const char *env = std::getenv("AOC_HUGE_PAGES");
+    if (!env) {
+      return HugePageMode::off;
+    }
+    if (std::strcmp(env, "hugetlb") == 0) {
+      return HugePageMode::hugetlb;
+    }
+    if (std::strcmp(env, "thp") == 0) {
+      return HugePageMode::thp;
+    }
+    return std::atoi(env) != 0 ? HugePageMode::thp : HugePageMode::off;
+  }();
+  return mode;
+}
+
+// Rounds size up to whole huge pages.
+inline size_t hugePageBytes(size_t size) {
+  return (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+}
+
+// size bytes of huge pages, a multiple of hugePageSize. nullptr if the memory
+// can't be mapped.
+inline void *allocateHugePages(size_t size, HugePageMode mode) {
+  if (mode == HugePageMode::hugetlb) {
+    void *ret = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                       -1, 0);
+    if (ret != MAP_FAILED) {
+      return ret;
+    }
+  }
+  // Transparent huge pages need 2 MiB aligned ranges, so map a page more and
+  // trim it.
+  void *mapped = ::mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  const auto begin = reinterpret_cast<uintptr_t>(mapped);
+  const uintptr_t aligned =
+      (begin + hugePageSize - 1) & ~(uintptr_t(hugePageSize) - 1);
+  const size_t head = aligned - begin;
+  if (head > 0) {
+    ::munmap(mapped, head);
+  }
+  if (head < hugePageSize) {
+    ::munmap(reinterpret_cast<void *>(aligned + size), hugePageSize - head);
+  }
+  char *ret = reinterpret_cast<char *>(aligned);
+  ::madvise(ret, size, MADV_HUGEPAGE);
+  // Prefaults the range, per 4 KiB page in case the kernel has no huge pages
+  // to spare.
+  for (size_t offset = 0; offset < size; offset += 4096) {
+    ret[offset] = 0;
+  }
+  return ret;
+}
+
+inline void freeHugePages(void *data, size_t size) { ::munmap(data, size); }
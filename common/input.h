@@ -0,0 +1,119 @@
+#pragma once
+
+#include "line_index.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Path of the puzzle input read by the solvers. Relative to the working
+// directory, i.e. the day's directory when running ./solve there. The runner
+// points it at the right day per thread.
+inline thread_local std::string inputPath = "input.txt";
+
+// Takes the input from the command line if given, "-" reads stdin (see
+// line_reader.h). Usage: ./solve [input]
+inline void setInputPath(int argc, char *argv[]) {
+  if (argc > 1) {
+    inputPath = argv[1];
+  }
+}
+
+// stdin can only be read once, so the days solve both parts in one pass.
+inline bool inputIsStdin() { return inputPath == "-"; }
+
+// Writable line of a privately mapped input. Writes are copy on write and never
+// reach the file.
+struct MutableLine {
+  char *ptr;
+  size_t len;
+
+  char &operator[](size_t i) const { return ptr[i]; }
+  size_t size() const { return len; }
+};
+
+// Memory maps the input and indexes its lines (see line_index.h), so solvers
+// can work on std::string_view lines without copying every line into its own
+// std::string.
+class InputFile {
+public:
+  explicit InputFile(const std::string &path, bool writable = false) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open " + path + ".");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat " + path + ".");
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+      const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+      // Prefaulting is faster than faulting in page by page while indexing.
+      void *addr =
+          ::mmap(nullptr, size, prot, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map " + path + ".");
+      }
+      buffer = static_cast<char *>(addr);
+    }
+    ::close(fd);
+    ::indexLines(data(), lineViews);
+  }
+
+  ~InputFile() {
+    if (buffer) {
+      ::munmap(buffer, size);
+    }
+  }
+
+  InputFile(const InputFile &) = delete;
+  InputFile &operator=(const InputFile &) = delete;
+
+  std::string_view data() const { return std::string_view(buffer, size); }
+  const std::vector<std::string_view> &lines() const { return lineViews; }
+
+  // Splits the lines into at most numChunks ranges [first, last) of lines with
+  // about the same number of bytes, e.g. to process them on several threads.
+  std::vector<std::pair<size_t, size_t>> lineChunks(size_t numChunks) const {
+    std::vector<std::pair<size_t, size_t>> chunks;
+    numChunks = std::max<size_t>(1, numChunks);
+    size_t first = 0;
+    for (size_t i = 1; i <= numChunks && first < lineViews.size(); ++i) {
+      const char *target = buffer + size * i / numChunks;
+      const auto it = std::lower_bound(
+          lineViews.begin() + first, lineViews.end(), target,
+          [](std::string_view line, const char *t) { return line.data() < t; });
+      const size_t last =
+          (i == numChunks) ? lineViews.size() : it - lineViews.begin();
+      if (last > first) {
+        chunks.emplace_back(first, last);
+        first = last;
+      }
+    }
+    return chunks;
+  }
+
+  // Only for inputs mapped as writable.
+  std::vector<MutableLine> mutableLines() const {
+    std::vector<MutableLine> ret;
+    ret.reserve(lineViews.size());
+    for (const auto &line : lineViews) {
+      ret.push_back(MutableLine{buffer + (line.data() - buffer), line.size()});
+    }
+    return ret;
+  }
+
+private:
+  char *buffer = nullptr;
+  size_t size = 0;
+  std::vector<std::string_view> lineViews;
+};
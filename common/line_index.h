@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AOC_X86 1
+#endif
+
+// Splitting the input into lines. The kernels scan for '\n' and append one
+// std::string_view per line, so the line index is built in a single pass over
+// the bytes. Like std::getline, a trailing newline doesn't produce an empty
+// last line.
+
+using IndexLinesFunc = void (*)(const char *data, size_t size,
+                                std::vector<std::string_view> &lines);
+
+// Handles the remainder of the vectorized kernels as well.
+inline void indexLinesScalar(const char *data, size_t size,
+                             std::vector<std::string_view> &lines,
+                             size_t lineStart = 0, size_t pos = 0) {
+  while (pos < size) {
+    const void *eol = std::memchr(data + pos, '\n', size - pos);
+    if (!eol) {
+      break;
+    }
+    pos = static_cast<const char *>(eol) - data;
+    lines.emplace_back(data + lineStart, pos - lineStart);
+    lineStart = ++pos;
+  }
+  if (lineStart < size) {
+    lines.emplace_back(data + lineStart, size - lineStart);
+  }
+}
+
+#ifdef AOC_X86
+// Emits a line for each bit set in the newline mask of the block at pos.
+inline void emitLines(const char *data, size_t pos, unsigned int mask,
+                      size_t &lineStart, std::vector<std::string_view> &lines) {
+  while (mask) {
+    const size_t eol = pos + __builtin_ctz(mask);
+    lines.emplace_back(data + lineStart, eol - lineStart);
+    lineStart = eol + 1;
+    mask &= mask - 1;
+  }
+}
+
+__attribute__((target("sse2"))) inline void
+indexLinesSSE2(const char *data, size_t size,
+               std::vector<std::string_view> &lines) {
+  const __m128i newline = _mm_set1_epi8('\n');
+  size_t lineStart = 0;
+  size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    const unsigned int mask = static_cast<unsigned int>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    emitLines(data, pos, mask, lineStart, lines);
+  }
+  indexLinesScalar(data, size, lines, lineStart, pos);
+}
+
+__attribute__((target("avx2"))) inline void
+indexLinesAVX2(const char *data, size_t size,
+               std::vector<std::string_view> &lines) {
+  const __m256i newline = _mm256_set1_epi8('\n');
+  size_t lineStart = 0;
+  size_t pos = 0;
+  // Two blocks per iteration, most lines are longer than 32 bytes anyway.
+  for (; pos + 64 <= size; pos += 64) {
+    const __m256i lo =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    const __m256i hi =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos + 32));
+    const unsigned int maskLo = static_cast<unsigned int>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)));
+    const unsigned int maskHi = static_cast<unsigned int>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)));
+    emitLines(data, pos, maskLo, lineStart, lines);
+    emitLines(data, pos + 32, maskHi, lineStart, lines);
+  }
+  indexLinesScalar(data, size, lines, lineStart, pos);
+}
+#endif
+
+// Picks the widest kernel the CPU supports. AOC_SIMD=scalar|sse2|avx2 forces
+// a kernel, e.g. to compare them. Other values are rejected. A forced kernel
+// the CPU doesn't support falls back to the next narrower one with a warning,
+// so the measurements aren't mislabelled silently.
+inline IndexLinesFunc selectIndexLines() {
+  const char *env = std::getenv("AOC_SIMD");
+  const std::string forced = env ? env : "";
+  if (!forced.empty() && forced != "scalar" && forced != "sse2" &&
+      forced != "avx2") {
+    throw std::runtime_error("Unknown AOC_SIMD=" + forced +
+                             ", expected scalar, sse2 or avx2.");
+  }
+  const auto warnFallback = [&](const char *kernel) {
+    std::cerr << "AOC_SIMD=" << forced << " is not supported, using "
+              << kernel << " instead.\n";
+  };
+#ifdef AOC_X86
+  if ((forced.empty() || forced == "avx2") &&
+      __builtin_cpu_supports("avx2")) {
+    return &indexLinesAVX2;
+  }
+  if ((forced.empty() || forced == "sse2" || forced == "avx2") &&
+      __builtin_cpu_supports("sse2")) {
+    if (forced == "avx2") {
+      warnFallback("sse2");
+    }
+    return &indexLinesSSE2;
+  }
+#endif
+  if (forced == "sse2" || forced == "avx2") {
+    warnFallback("scalar");
+  }
+  return [](const char *data, size_t size,
+            std::vector<std::string_view> &lines) {
+    indexLinesScalar(data, size, lines);
+  };
+}
+
+inline void indexLines(std::string_view data,
+                       std::vector<std::string_view> &lines) {
+  static const IndexLinesFunc func = selectIndexLines();
+  // Regrowing the index costs more than the scan on big inputs. Estimate the
+  // number of lines from a sample at the start instead.
+  const auto sample = data.substr(0, 64 * 1024);
+  const size_t sampleLines = std::count(sample.begin(), sample.end(), '\n');
+  lines.reserve(lines.size() +
+                (sampleLines + 1) * (data.size() / (sample.size() + 1) + 1));
+  func(data.data(), data.size(), lines);
+}
+
+// Splits data into at most numChunks chunks of about the same size. Each chunk
+// ends right after a '\n' (or at the end of the data), so the chunks can be
+// processed independently, e.g. by several threads.
+inline std::vector<std::string_view> splitAtLines(std::string_view data,
+                                                  size_t numChunks) {
+  std::vector<std::string_view> chunks;
+  numChunks = std::max<size_t>(1, numChunks);
+  const size_t targetSize = data.size() / numChunks + 1;
+  size_t start = 0;
+  while (start < data.size()) {
+    size_t end = std::min(data.size(), start + targetSize);
+    if (end < data.size()) {
+      const auto eol = data.find('\n', end - 1);
+      end = (eol == std::string_view::npos) ? data.size() : eol + 1;
+    }
+    chunks.push_back(data.substr(start, end - start));
+    start = end;
+  }
+  return chunks;
+}
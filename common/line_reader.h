@@ -0,0 +1,237 @@
+#pragma once
+
+#include "line_index.h"
+#include "read_ahead.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Streams the records of a file, or of stdin if the path is "-", through a
+// buffer of fixed size. Unlike InputFile, neither the input nor an index of
+// all its lines is held in memory, so inputs of any size can be piped in.
+// Records are separated by delim, '\n' for lines. Like std::getline, a
+// trailing separator doesn't produce an empty last record. Only a record
+// longer than the buffer grows it.
+// Inputs larger than a chunk and pipes are read ahead on a background thread
+// or with io_uring (see read_ahead.h), so reading overlaps with the caller's
+// processing of the previous chunk. Smaller files don't pay for the setup.
+// The views handed out stay valid until the next call.
+//   LineReader reader(inputPath);
+//   std::string_view line;
+//   while (reader.next(line)) { ... }
+class LineReader {
+public:
+  static constexpr size_t defaultChunkSize = 1 << 20;
+
+  explicit LineReader(const std::string &path_, char delim_ = '\n',
+                      size_t chunkSize = defaultChunkSize)
+      : path(path_), delim(delim_), capacity(std::max<size_t>(chunkSize, 1)) {
+    if (path == "-") {
+      fd = STDIN_FILENO;
+    } else {
+      fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path + ".");
+      }
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    struct stat st;
+    const bool large = ::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+                       static_cast<size_t>(st.st_size) > capacity;
+    if (large && readAheadMode() != ReadAheadMode::off) {
+      ahead = std::make_unique<ReadAhead>(fd, capacity, reserveSize);
+      capacity = 0;
+    } else {
+      // Not value initialized, only the pages we read into get touched.
+      buffer.reset(new char[capacity]);
+      data = buffer.get();
+    }
+  }
+
+  ~LineReader() {
+    // Stops reading ahead before the file is closed.
+    ahead.reset();
+    if (fd != STDIN_FILENO) {
+      ::close(fd);
+    }
+  }
+
+  LineReader(const LineReader &) = delete;
+  LineReader &operator=(const LineReader &) = delete;
+
+  bool next(std::string_view &record) {
+    while (true) {
+      const void *sep = std::memchr(data + begin, delim, end - begin);
+      if (sep) {
+        const size_t pos = static_cast<const char *>(sep) - data;
+        record = std::string_view(data + begin, pos - begin);
+        begin = pos + 1;
+        return true;
+      }
+      if (eof) {
+        return takeRest(record);
+      }
+      fill();
+    }
+  }
+
+  // All complete records in the buffer, at least one unless the input ended.
+  // Lets a batch be processed in parallel while the memory stays bounded.
+  bool nextBatch(std::vector<std::string_view> &records) {
+    records.clear();
+    while (true) {
+      const char *first = data + begin;
+      const void *sep = ::memrchr(first, delim, end - begin);
+      if (sep) {
+        const size_t size = static_cast<const char *>(sep) - first;
+        if (delim == '\n' && size > 0) {
+          indexLines(std::string_view(first, size), records);
+          // indexLines() drops the empty line in front of the separator.
+          if (first[size - 1] == '\n') {
+            records.emplace_back(first + size, 0);
+          }
+        } else {
+          splitRecords(std::string_view(first, size), records);
+        }
+        begin += size + 1;
+        return true;
+      }
+      if (eof) {
+        std::string_view record;
+        if (takeRest(record)) {
+          records.push_back(record);
+          return true;
+        }
+        return false;
+      }
+      fill();
+    }
+  }
+
+  template <typename Func> void forEach(Func func) {
+    std::string_view record;
+    while (next(record)) {
+      func(record);
+    }
+  }
+
+private:
+  // The record after the last separator.
+  bool takeRest(std::string_view &record) {
+    if (begin == end) {
+      return false;
+    }
+    record = std::string_view(data + begin, end - begin);
+    begin = end;
+    return true;
+  }
+
+  void splitRecords(std::string_view data,
+                    std::vector<std::string_view> &records) const {
+    size_t start = 0;
+    for (size_t pos = data.find(delim); pos != std::string_view::npos;
+         pos = data.find(delim, start)) {
+      records.push_back(data.substr(start, pos - start));
+      start = pos + 1;
+    }
+    records.push_back(data.substr(start));
+  }
+
+  // Moves the unconsumed bytes to the front and reads behind them.
+  void fill() {
+    if (ahead) {
+      fillAhead();
+      return;
+    }
+    if (begin > 0) {
+      std::memmove(buffer.get(), buffer.get() + begin, end - begin);
+      end -= begin;
+      begin = 0;
+    }
+    if (end == capacity) {
+      // A single record fills the whole buffer.
+      std::unique_ptr<char[]> grown(new char[capacity * 2]);
+      std::memcpy(grown.get(), buffer.get(), end);
+      buffer = std::move(grown);
+      data = buffer.get();
+      capacity *= 2;
+    }
+    ssize_t n;
+    do {
+      n = ::read(fd, buffer.get() + end, capacity - end);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+      throw std::runtime_error("Failed to read " + path + ".");
+    }
+    if (n == 0) {
+      eof = true;
+    }
+    end += n;
+  }
+
+  // Continues with the next chunk read ahead. The unconsumed bytes, usually
+  // part of a line, are put in front of it, into its reserve. Only a longer
+  // rest is joined with the chunk in our own buffer.
+  void fillAhead() {
+    const size_t rest = end - begin;
+    ReadAhead::Chunk *next = ahead->acquire();
+    if (!next) {
+      eof = true;
+      return;
+    }
+    const size_t size = next->size;
+    if (rest <= reserveSize) {
+      char *dest = next->data - rest;
+      std::memcpy(dest, data + begin, rest);
+      releaseChunk();
+      chunk = next;
+      data = dest;
+    } else {
+      if (rest + size > capacity) {
+        capacity = std::max(2 * capacity, rest + size);
+        std::unique_ptr<char[]> grown(new char[capacity]);
+        std::memcpy(grown.get(), data + begin, rest);
+        buffer = std::move(grown);
+      } else {
+        std::memmove(buffer.get(), data + begin, rest);
+      }
+      std::memcpy(buffer.get() + rest, next->data, size);
+      ahead->release(next);
+      releaseChunk();
+      data = buffer.get();
+    }
+    begin = 0;
+    end = rest + size;
+  }
+
+  void releaseChunk() {
+    if (chunk) {
+      ahead->release(chunk);
+      chunk = nullptr;
+    }
+  }
+
+  std::string path;
+  char delim;
+  int fd = -1;
+  size_t capacity;
+  std::unique_ptr<char[]> buffer;
+  // The chunk or buffer the unconsumed bytes are in. Never null, so the empty
+  // range before the first chunk can be searched as well.
+  static inline char noData = 0;
+  char *data = &noData;
+  static constexpr size_t reserveSize = 1 << 16;
+  std::unique_ptr<ReadAhead> ahead;
+  ReadAhead::Chunk *chunk = nullptr;
+  size_t begin = 0;
+  size_t end = 0;
+  bool eof = false;
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Cursor for parsing a line (or any other text) without allocations. It
+// replaces the std::istringstream / std::stoi(line.substr(...)) combos, which
+// construct a stream and temporary strings per line.
+// Parsing errors throw. It also works at compile time, on the embedded input
+// (see embed.h).
+class Parser {
+public:
+  constexpr explicit Parser(std::string_view str_) : str(str_) {}
+
+  constexpr bool done() const { return pos >= str.size(); }
+  constexpr char peek() const { return str[pos]; }
+  constexpr size_t position() const { return pos; }
+  constexpr std::string_view rest() const { return str.substr(pos); }
+
+  constexpr void skip(size_t n) { pos = std::min(str.size(), pos + n); }
+
+  constexpr void skipWhitespace() {
+    while (pos < str.size() && isSpace(str[pos])) {
+      ++pos;
+    }
+  }
+
+  // Moves to the next occurrence of ch or the end.
+  constexpr void skipUntil(char ch) {
+    pos = std::min(str.size(), str.find(ch, pos));
+  }
+
+  // Moves behind the next occurrence of ch or to the end.
+  constexpr void skipPast(char ch) {
+    skipUntil(ch);
+    skip(1);
+  }
+
+  // Consumes ch if it is the next character.
+  constexpr bool consume(char ch) {
+    if (!done() && str[pos] == ch) {
+      ++pos;
+      return true;
+    }
+    return false;
+  }
+
+  // Skips everything up to the next number and parses it. A '-' directly in
+  // front of the digits is taken as sign for signed types.
+  template <typename T> constexpr T nextInt(int base = 10) {
+    T value = 0;
+    if (!tryNextInt(value, base)) {
+      throw std::runtime_error("Failed to parse number in \"" +
+                               std::string(str) + "\".");
+    }
+    return value;
+  }
+
+  // Like nextInt() but returns false instead of throwing if there is no
+  // number left. Overflows are not detected, the inputs are trusted.
+  template <typename T> constexpr bool tryNextInt(T &value, int base = 10) {
+    const char *it = str.data() + pos;
+    const char *const end = str.data() + str.size();
+    bool negative = false;
+    for (; it != end; ++it) {
+      if (digitValue(*it) < base) {
+        break;
+      }
+      if (std::is_signed_v<T> && *it == '-' && it + 1 != end &&
+          digitValue(it[1]) < base) {
+        negative = true;
+        ++it;
+        break;
+      }
+    }
+    if (it == end) {
+      pos = str.size();
+      return false;
+    }
+    // A plain loop instead of std::from_chars, which is a lot slower in
+    // unoptimized builds and the days are built without optimizations.
+    T result = 0;
+    for (int digit = 0; it != end && (digit = digitValue(*it)) < base;
+         ++it) {
+      result = result * base + digit;
+    }
+    value = negative ? -result : result;
+    pos = it - str.data();
+    return true;
+  }
+
+  // Next whitespace separated token.
+  constexpr std::string_view nextWord() {
+    skipWhitespace();
+    const size_t start = pos;
+    while (pos < str.size() && !isSpace(str[pos])) {
+      ++pos;
+    }
+    return str.substr(start, pos - start);
+  }
+
+  // Next token ending before delim (or at the end). The delimiter is consumed.
+  constexpr std::string_view nextUntil(char delim) {
+    const size_t start = pos;
+    skipUntil(delim);
+    const auto ret = str.substr(start, pos - start);
+    skip(1);
+    return ret;
+  }
+
+  // Next field of a fixed width, e.g. the hand in "32T3K 765".
+  constexpr std::string_view nextFixed(size_t width) {
+    const auto ret = str.substr(pos, width);
+    skip(width);
+    return ret;
+  }
+
+  // Number in a field of a fixed width, e.g. the hex digits of "#70c710".
+  template <typename T>
+  constexpr T nextFixedInt(size_t width, int base = 10) {
+    const auto field = nextFixed(width);
+    T value = 0;
+    for (const char ch : field) {
+      const int digit = digitValue(ch);
+      if (digit >= base) {
+        throw std::runtime_error("Failed to parse number \"" +
+                                 std::string(field) + "\".");
+      }
+      value = value * base + digit;
+    }
+    return value;
+  }
+
+private:
+  static constexpr bool isSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+  }
+
+  // Value of a digit up to base 36, 36 or more for anything else.
+  static constexpr int digitValue(char ch) {
+    if ('0' <= ch && ch <= '9') {
+      return ch - '0';
+    }
+    if ('a' <= ch && ch <= 'z') {
+      return ch - 'a' + 10;
+    }
+    if ('A' <= ch && ch <= 'Z') {
+      return ch - 'A' + 10;
+    }
+    return 36;
+  }
+
+  std::string_view str;
+  size_t pos = 0;
+};
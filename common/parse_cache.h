@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Binary cache of a day's parsed input, stored next to the input as
+// <input>.<name>.cache. Enabled with AOC_PARSE_CACHE=1.
+// The file starts with a header holding a hash of the input's content and the
+// version of the day's encoding. If both still match, the day reads its parsed
+// representation from the mapped file instead of parsing the text again.
+// Arrays are read in place, so the views into the cache stay valid as long as
+// the ParseCache lives. Bump the version whenever the encoding changes.
+//   const ParseCache cache(inputPath, "network", 1);
+//   if (auto reader = cache.load()) {
+//     ... read it back ...
+//   } else {
+//     ... parse cache.input() ...
+//     cache.store(writer);
+//   }
+
+inline bool parseCacheEnabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("AOC_PARSE_CACHE");
+    return env && std::atoi(env) != 0;
+  }();
+  return enabled;
+}
+
+// 64 bit hash of the content, eight bytes at a time.
+inline uint64_t hashBytes(std::string_view data) {
+  uint64_t hash = 0x9e3779b97f4a7c15ULL ^ data.size();
+  const auto mix = [](uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  };
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data.data() + i, 8);
+    hash = mix(hash ^ word);
+  }
+  uint64_t tail = 0;
+  if (i < data.size()) {
+    std::memcpy(&tail, data.data() + i, data.size() - i);
+  }
+  return mix(hash ^ tail);
+}
+
+// Read only mapping of a whole file. Empty if the file doesn't exist and
+// missingOk is set.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path, bool missingOk = false) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      if (missingOk) {
+        return;
+      }
+      throw std::runtime_error("Failed to open " + path + ".");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat " + path + ".");
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+      void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map " + path + ".");
+      }
+      buffer = static_cast<const char *>(addr);
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile() {
+    if (buffer) {
+      ::munmap(const_cast<char *>(buffer), size);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view data() const { return std::string_view(buffer, size); }
+
+private:
+  const char *buffer = nullptr;
+  size_t size = 0;
+};
+
+// Builds the payload. Only trivially copyable values can be written.
+class CacheWriter {
+public:
+  template <typename T> void write(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  // Count and elements. The count is aligned to 8 bytes and so are the
+  // elements, so the reader can hand out a pointer into the mapping.
+  template <typename T> void writeArray(const T *data, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= 8);
+    buffer.resize((buffer.size() + 7) / 8 * 8, '\0');
+    write<uint64_t>(count);
+    buffer.append(reinterpret_cast<const char *>(data), count * sizeof(T));
+  }
+  template <typename T> void writeArray(const std::vector<T> &values) {
+    writeArray(values.data(), values.size());
+  }
+
+  void writeString(std::string_view str) { writeArray(str.data(), str.size()); }
+
+  const std::string &data() const { return buffer; }
+
+private:
+  std::string buffer;
+};
+
+// Reads the payload back in the order it was written. A payload ending early
+// throws, which only happens if the file got corrupted.
+class CacheReader {
+public:
+  explicit CacheReader(std::string_view payload_) : payload(payload_) {}
+
+  template <typename T> T read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  // Pointer into the mapping and count.
+  template <typename T> std::pair<const T *, size_t> readArray() {
+    take((pos + 7) / 8 * 8 - pos); // Padding
+    const auto count = read<uint64_t>();
+    const auto *data = reinterpret_cast<const T *>(take(count * sizeof(T)));
+    return {data, count};
+  }
+  template <typename T> std::vector<T> readVector() {
+    const auto [data, count] = readArray<T>();
+    return std::vector<T>(data, data + count);
+  }
+
+  std::string_view readString() {
+    const auto [data, count] = readArray<char>();
+    return std::string_view(data, count);
+  }
+
+private:
+  const char *take(size_t n) {
+    if (n > payload.size() - pos) {
+      throw std::runtime_error("Parse cache is truncated.");
+    }
+    const char *ret = payload.data() + pos;
+    pos += n;
+    return ret;
+  }
+
+  std::string_view payload;
+  size_t pos = 0;
+};
+
+class ParseCache {
+public:
+  ParseCache(const std::string &inputPath, const std::string &name,
+             uint32_t version_)
+      : path(inputPath + "." + name + ".cache"), version(version_),
+        inputFile(inputPath) {
+    if (parseCacheEnabled()) {
+      inputHash = hashBytes(inputFile.data());
+      cacheFile.emplace(path, true);
+    }
+  }
+
+  // The text of the input, to parse on a miss.
+  std::string_view input() const { return inputFile.data(); }
+
+  // Reader of the payload if the cache is enabled and was written by the same
+  // version from the same input.
+  std::optional<CacheReader> load() const {
+    if (!cacheFile || cacheFile->data().size() < sizeof(Header)) {
+      return std::nullopt;
+    }
+    const auto data = cacheFile->data();
+    Header header;
+    std::memcpy(&header, data.data(), sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 ||
+        header.version != version || header.inputHash != inputHash ||
+        header.inputSize != input().size() ||
+        header.payloadSize != data.size() - sizeof(Header)) {
+      return std::nullopt;
+    }
+    return CacheReader(data.substr(sizeof(Header)));
+  }
+
+  // Writes the payload if the cache is enabled. Failing to write isn't an
+  // error, the next run parses again.
+  void store(const CacheWriter &writer) const {
+    if (!parseCacheEnabled()) {
+      return;
+    }
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = version;
+    header.inputHash = inputHash;
+    header.inputSize = input().size();
+    header.payloadSize = writer.data().size();
+    // Written under a temporary name and renamed, so concurrent runs never
+    // see half a file.
+    const std::string tmpPath = path + "." + std::to_string(::getpid());
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return;
+    }
+    const bool ok =
+        ::write(fd, &header, sizeof(header)) == sizeof(header) &&
+        ::write(fd, writer.data().data(), writer.data().size()) ==
+            static_cast<ssize_t>(writer.data().size());
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+      ::unlink(tmpPath.c_str());
+    }
+  }
+
+private:
+  // 64 bytes, so the payload is aligned in the mapping.
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved = 0;
+    uint64_t inputHash;
+    uint64_t inputSize;
+    uint64_t payloadSize;
+    char padding[24] = {};
+  };
+  static_assert(sizeof(Header) == 64);
+  static constexpr char magic[8] = {'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E'};
+
+  std::string path;
+  uint32_t version;
+  MappedFile inputFile;
+  uint64_t inputHash = 0;
+  std::optional<MappedFile> cacheFile;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Hardware performance counters of the calling thread via perf_event_open.
+// Only user space is counted, which works with the default
+// kernel.perf_event_paranoid setting. Counters the CPU, the kernel or the
+// virtual machine don't provide are skipped. If none can be opened, e.g. in a
+// container without perf support, the counters are reported as unavailable.
+
+enum class PerfEvent {
+  CYCLES,
+  INSTRUCTIONS,
+  L1D_MISSES,
+  LLC_MISSES,
+  BRANCH_MISSES,
+  DTLB_MISSES,
+};
+inline constexpr size_t numPerfEvents = 6;
+
+inline const char *perfEventName(size_t event) {
+  static const char *const names[numPerfEvents] = {
+      "cycles",     "instructions",  "l1d_misses",
+      "llc_misses", "branch_misses", "dtlb_misses"};
+  return names[event];
+}
+
+// Counts per measured run. Negative if the counter isn't available.
+struct PerfCounts {
+  std::array<double, numPerfEvents> values;
+
+  PerfCounts() { values.fill(-1.0); }
+
+  double operator[](PerfEvent event) const {
+    return values[static_cast<size_t>(event)];
+  }
+  bool has(PerfEvent event) const { return (*this)[event] >= 0.0; }
+  bool any() const {
+    for (const double value : values) {
+      if (value >= 0.0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  double ipc() const {
+    return has(PerfEvent::CYCLES) && has(PerfEvent::INSTRUCTIONS) &&
+                   (*this)[PerfEvent::CYCLES] > 0.0
+               ? (*this)[PerfEvent::INSTRUCTIONS] / (*this)[PerfEvent::CYCLES]
+               : -1.0;
+  }
+};
+
+class PerfCounters {
+public:
+  PerfCounters() {
+    const std::array<std::pair<uint32_t, uint64_t>, numPerfEvents> configs = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    }};
+    fds.fill(-1);
+    totals.fill(0.0);
+    for (size_t i = 0; i < numPerfEvents; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = configs[i].first;
+      attr.config = configs[i].second;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // To scale the counts if the kernel multiplexes the counters.
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds[i] = static_cast<int>(
+          ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+      if (fds[i] < 0 && error.empty()) {
+        error = std::strerror(errno);
+      }
+    }
+  }
+
+  ~PerfCounters() {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool available() const {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Why the first counter that failed to open isn't available.
+  const std::string &lastError() const { return error; }
+
+  void start() {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  // Stops counting and adds the counts since start() to the totals.
+  void stop() {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    for (size_t i = 0; i < numPerfEvents; ++i) {
+      uint64_t data[3];
+      if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != sizeof(data)) {
+        continue;
+      }
+      const double scale =
+          data[2] > 0 ? static_cast<double>(data[1]) / data[2] : 0.0;
+      totals[i] += data[0] * scale;
+    }
+    ++runs;
+  }
+
+  // Average counts of the runs so far.
+  PerfCounts counts() const {
+    PerfCounts ret;
+    for (size_t i = 0; i < numPerfEvents; ++i) {
+      if (fds[i] >= 0 && runs > 0) {
+        ret.values[i] = totals[i] / runs;
+      }
+    }
+    return ret;
+  }
+
+private:
+  std::array<int, numPerfEvents> fds;
+  std::array<double, numPerfEvents> totals;
+  int runs = 0;
+  std::string error;
+};
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unordered_map>
+#include <vector>
+
+// Sampling profiler for the runner (--profile). Once started, a SIGPROF timer
+// interrupts the program every millisecond of CPU time (at most once per
+// kernel tick). Inside the measured runs of measureTime() the handler records
+// the call stack of the interrupted thread. After each run the stacks are
+// symbolized and added to the flat profile of the day (benchGroup), which
+// report() prints:
+//   Self  the share of samples the function itself was executing,
+//   Total the share of samples it was on the stack, i.e. including callees.
+// Only the thread running the part is sampled, not the workers of the
+// ThreadPool, so run with AOC_THREADS=1 to attribute everything. Functions
+// are named via dladdr, which only sees exported symbols (the runner links
+// with -rdynamic); others show as module+offset.
+// While not started a ProfileScope only costs a branch.
+
+class SamplingProfiler {
+public:
+  static SamplingProfiler &instance() {
+    static SamplingProfiler profiler;
+    return profiler;
+  }
+
+  bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+  // Installs the signal handler and starts the timer.
+  void start(int samplesPerSecond = 1000) {
+    // backtrace() loads the unwinder on its first call, which must not happen
+    // in the signal handler.
+    void *frame;
+    ::backtrace(&frame, 1);
+    struct sigaction action {};
+    action.sa_sigaction = onSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGPROF, &action, nullptr);
+    const int intervalUs = 1000000 / std::max(1, samplesPerSecond);
+    itimerval timer{};
+    timer.it_interval.tv_usec = intervalUs;
+    timer.it_value.tv_usec = intervalUs;
+    ::setitimer(ITIMER_PROF, &timer, nullptr);
+    active = true;
+  }
+
+  // Starts sampling the calling thread for group.
+  void enter(const std::string &group) {
+    if (!buffer) {
+      buffer = new Buffer();
+    }
+    buffer->group = group;
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->dropped = 0;
+    buffer->active.store(true, std::memory_order_release);
+  }
+
+  // Stops sampling the calling thread and adds its samples to the profile.
+  void leave() {
+    buffer->active.store(false, std::memory_order_release);
+    const size_t count = buffer->count.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &profile = profiles[buffer->group];
+    profile.samples += count;
+    profile.dropped += buffer->dropped;
+    for (size_t i = 0; i < count; ++i) {
+      const void *const *frames = &buffer->frames[i * maxDepth];
+      std::set<size_t> seen;
+      for (int k = 0; k < buffer->depths[i]; ++k) {
+        // Return addresses point behind the call, which may already be the
+        // next function.
+        const size_t symbol =
+            symbolIndex(static_cast<const char *>(frames[k]) - (k > 0));
+        if (k == 0) {
+          ++profile.counts[symbol].self;
+        }
+        if (seen.insert(symbol).second) {
+          ++profile.counts[symbol].total;
+        }
+      }
+    }
+  }
+
+  // Flat profile per group, the top functions by self time.
+  void report(std::ostream &os, size_t top = 15) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[group, profile] : profiles) {
+      os << "\nProfile of " << group << ": " << profile.samples << " samples";
+      if (profile.dropped > 0) {
+        os << ", " << profile.dropped << " dropped";
+      }
+      os << "\n";
+      if (profile.samples == 0) {
+        continue;
+      }
+      std::vector<std::pair<size_t, Counts>> rows(profile.counts.begin(),
+                                                   profile.counts.end());
+      std::sort(rows.begin(), rows.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.second.self != rhs.second.self
+                   ? lhs.second.self > rhs.second.self
+                   : lhs.second.total > rhs.second.total;
+      });
+      os << std::right << std::setw(7) << "Self" << std::setw(8) << "Total"
+         << "  Function\n";
+      for (size_t i = 0; i < std::min(top, rows.size()); ++i) {
+        const auto &[symbol, counts] = rows[i];
+        os << std::fixed << std::setprecision(1) << std::setw(6)
+           << 100.0 * counts.self / profile.samples << "%" << std::setw(7)
+           << 100.0 * counts.total / profile.samples << "%  "
+           << std::defaultfloat << abbreviate(symbols[symbol]) << "\n";
+      }
+    }
+  }
+
+private:
+  static constexpr int maxDepth = 32;
+  // Per run, 8 s of CPU time at the default rate.
+  static constexpr size_t capacity = 8192;
+
+  // Written by the signal handler of the owning thread only.
+  struct Buffer {
+    std::string group;
+    std::unique_ptr<void *[]> frames{new void *[capacity * maxDepth]};
+    std::unique_ptr<int[]> depths{new int[capacity]};
+    std::atomic<size_t> count{0};
+    std::atomic<bool> active{false};
+    size_t dropped = 0;
+  };
+
+  struct Counts {
+    size_t self = 0;
+    size_t total = 0;
+  };
+
+  struct Profile {
+    size_t samples = 0;
+    size_t dropped = 0;
+    std::map<size_t, Counts> counts;
+  };
+
+  SamplingProfiler() = default;
+
+  static const void *instructionPointer(void *context) {
+    const auto *uc = static_cast<const ucontext_t *>(context);
+#if defined(__x86_64__)
+    return reinterpret_cast<const void *>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+    return reinterpret_cast<const void *>(uc->uc_mcontext.pc);
+#else
+    (void)uc;
+    return nullptr;
+#endif
+  }
+
+  static void onSignal(int, siginfo_t *, void *context) {
+    Buffer *const current = buffer;
+    if (!current || !current->active.load(std::memory_order_acquire)) {
+      return;
+    }
+    // Unsupported architecture.
+    const void *ip = instructionPointer(context);
+    if (!ip) {
+      return;
+    }
+    const size_t i = current->count.load(std::memory_order_relaxed);
+    if (i >= capacity) {
+      ++current->dropped;
+      return;
+    }
+    const int savedErrno = errno;
+    void *stack[maxDepth + 8];
+    const int n = ::backtrace(stack, maxDepth + 8);
+    errno = savedErrno;
+    // The first frames are the handler's, up to the interrupted instruction.
+    // If the unwinder didn't get past the signal frame, only the interrupted
+    // function is recorded.
+    int first = 0;
+    while (first < n && stack[first] != ip) {
+      ++first;
+    }
+    void **frames = &current->frames[i * maxDepth];
+    int depth = 0;
+    frames[depth++] = const_cast<void *>(ip);
+    for (int k = first + 1; k < n && depth < maxDepth; ++k) {
+      frames[depth++] = stack[k];
+    }
+    current->depths[i] = depth;
+    current->count.store(i + 1, std::memory_order_release);
+  }
+
+  size_t symbolIndex(const void *address) {
+    const auto it = addressSymbols.find(address);
+    if (it != addressSymbols.end()) {
+      return it->second;
+    }
+    const std::string name = symbolize(address);
+    const auto [pos, inserted] = symbolIndices.emplace(name, symbols.size());
+    if (inserted) {
+      symbols.push_back(name);
+    }
+    addressSymbols.emplace(address, pos->second);
+    return pos->second;
+  }
+
+  static std::string symbolize(const void *address) {
+    Dl_info info;
+    if (::dladdr(address, &info) == 0) {
+      return "??";
+    }
+    if (info.dli_sname) {
+      int status = 0;
+      char *demangled =
+          abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      std::string name = status == 0 ? demangled : info.dli_sname;
+      std::free(demangled);
+      return name;
+    }
+    std::string module = info.dli_fname ? info.dli_fname : "??";
+    module = module.substr(module.rfind('/') + 1);
+    std::ostringstream oss;
+    oss << module << "+0x" << std::hex
+        << reinterpret_cast<uintptr_t>(address) -
+               reinterpret_cast<uintptr_t>(info.dli_fbase);
+    return oss.str();
+  }
+
+  // Template arguments make some names several lines long, so they are
+  // collapsed to <...>, e.g. FlatHashMap<...>::find(...).
+  static std::string abbreviate(const std::string &name) {
+    constexpr size_t maxLength = 100;
+    if (name.size() <= maxLength) {
+      return name;
+    }
+    std::string collapsed;
+    // Angle brackets of operator< and friends aren't template arguments.
+    if (name.find("operator<") == std::string::npos &&
+        name.find("operator>") == std::string::npos &&
+        name.find("operator-") == std::string::npos) {
+      int depth = 0;
+      for (const char c : name) {
+        if (c == '<' && depth++ == 0) {
+          collapsed += "<...";
+        }
+        if (depth == 0) {
+          collapsed += c;
+        }
+        if (c == '>' && depth > 0 && --depth == 0) {
+          collapsed += '>';
+        }
+      }
+    } else {
+      collapsed = name;
+    }
+    if (collapsed.size() <= maxLength) {
+      return collapsed;
+    }
+    return collapsed.substr(0, maxLength - 3) + "...";
+  }
+
+  static inline thread_local Buffer *buffer = nullptr;
+
+  std::atomic<bool> active{false};
+  std::mutex mutex;
+  std::map<std::string, Profile> profiles;
+  std::vector<std::string> symbols;
+  std::unordered_map<std::string, size_t> symbolIndices;
+  std::unordered_map<const void *, size_t> addressSymbols;
+};
+
+// Samples the calling thread for group while in scope, if the profiler runs.
+class ProfileScope {
+public:
+  explicit ProfileScope(const std::string &group)
+      : enabled(SamplingProfiler::instance().enabled()) {
+    if (enabled) {
+      SamplingProfiler::instance().enter(group);
+    }
+  }
+  ~ProfileScope() {
+    if (enabled) {
+      SamplingProfiler::instance().leave();
+    }
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  bool enabled;
+};
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Reads a file sequentially in chunks while the caller processes the previous
+// ones, so reading overlaps with parsing. numBuffers chunks are in flight.
+// Regular files are read with io_uring where the kernel allows it, otherwise
+// (and for pipes) a background thread reads them.
+// Each chunk is preceded by `reserve` free bytes, so a record cut at the end
+// of a chunk can be completed in front of the next one without copying it.
+//   ReadAhead ahead(fd, 1 << 20, 1 << 16);
+//   while (ReadAhead::Chunk *chunk = ahead.acquire()) {
+//     ... chunk->data[0..chunk->size) ...
+//     ahead.release(chunk);
+//   }
+// AOC_READ_AHEAD=0 turns it off (see LineReader), AOC_READ_AHEAD=thread
+// skips io_uring.
+
+enum class ReadAheadMode { off, thread, uring };
+
+inline ReadAheadMode readAheadMode() {
+  static const ReadAheadMode mode = [] {
+    const char *env = std::getenv("AOC_READ_AHEAD");
+    if (!env) {
+      return ReadAheadMode::uring;
+    }
+    if (std::string(env) == "thread") {
+      return ReadAheadMode::thread;
+    }
+    return std::atoi(env) != 0 ? ReadAheadMode::uring : ReadAheadMode::off;
+  }();
+  return mode;
+}
+
+// The parts of the io_uring interface we need, on the raw system calls.
+class IoUring {
+public:
+  // Throws if io_uring isn't available, e.g. blocked by seccomp.
+  explicit IoUring(unsigned int entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0) {
+      throw std::runtime_error("io_uring is not available.");
+    }
+    sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+      sqSize = cqSize = std::max(sqSize, cqSize);
+    }
+    sqRing = map(sqSize, IORING_OFF_SQ_RING);
+    cqRing = singleMmap ? sqRing : map(cqSize, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(map(sqesSize, IORING_OFF_SQES));
+    if (!sqRing || !cqRing || !sqes) {
+      unmap();
+      ::close(ringFd);
+      throw std::runtime_error("Failed to map the io_uring.");
+    }
+    sqTail = field(sqRing, params.sq_off.tail);
+    sqMask = *field(sqRing, params.sq_off.ring_mask);
+    sqArray = field(sqRing, params.sq_off.array);
+    cqHead = field(cqRing, params.cq_off.head);
+    cqTail = field(cqRing, params.cq_off.tail);
+    cqMask = *field(cqRing, params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(cqRing) +
+                                            params.cq_off.cqes);
+  }
+
+  ~IoUring() {
+    unmap();
+    ::close(ringFd);
+  }
+
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  // The iovec has to stay valid until the read completed. The caller keeps
+  // at most as many reads in flight as the ring has entries.
+  void submitRead(int fd, const iovec *iov, off_t offset, uint64_t userData) {
+    const unsigned int tail = *sqTail;
+    const unsigned int index = tail & sqMask;
+    io_uring_sqe &sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    // READV rather than READ, which needs Linux 5.6.
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(iov);
+    sqe.len = 1;
+    sqe.off = static_cast<uint64_t>(offset);
+    sqe.user_data = userData;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    enter(1, 0, 0);
+  }
+
+  // Blocks until a read completed.
+  io_uring_cqe waitCompletion() {
+    while (true) {
+      const unsigned int head = *cqHead;
+      if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe cqe = cqes[head & cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return cqe;
+      }
+      enter(0, 1, IORING_ENTER_GETEVENTS);
+    }
+  }
+
+private:
+  void *map(size_t size, off_t offset) const {
+    void *addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringFd, offset);
+    return addr == MAP_FAILED ? nullptr : addr;
+  }
+
+  void unmap() {
+    if (sqes) {
+      ::munmap(sqes, sqesSize);
+    }
+    if (cqRing && cqRing != sqRing) {
+      ::munmap(cqRing, cqSize);
+    }
+    if (sqRing) {
+      ::munmap(sqRing, sqSize);
+    }
+  }
+
+  static unsigned int *field(void *ring, unsigned int offset) {
+    return reinterpret_cast<unsigned int *>(static_cast<char *>(ring) +
+                                            offset);
+  }
+
+  void enter(unsigned int toSubmit, unsigned int minComplete,
+             unsigned int flags) {
+    while (::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags,
+                     nullptr, 0) < 0) {
+      if (errno != EINTR) {
+        throw std::runtime_error("io_uring_enter failed.");
+      }
+    }
+  }
+
+  int ringFd = -1;
+  size_t sqSize = 0;
+  size_t cqSize = 0;
+  size_t sqesSize = 0;
+  void *sqRing = nullptr;
+  void *cqRing = nullptr;
+  io_uring_sqe *sqes = nullptr;
+  unsigned int *sqTail = nullptr;
+  unsigned int sqMask = 0;
+  unsigned int *sqArray = nullptr;
+  unsigned int *cqHead = nullptr;
+  unsigned int *cqTail = nullptr;
+  unsigned int cqMask = 0;
+  io_uring_cqe *cqes = nullptr;
+};
+
+class ReadAhead {
+public:
+  struct Chunk {
+    char *data; // reserve bytes into the buffer.
+    size_t size;
+  };
+
+  // Doesn't take ownership of fd.
+  ReadAhead(int fd_, size_t chunkSize_, size_t reserve_,
+            unsigned int numBuffers = 4)
+      : fd(fd_), chunkSize(std::max<size_t>(chunkSize_, 1)), reserve(reserve_),
+        buffers(std::max(numBuffers, 2u)) {
+    struct stat st;
+    regularFile = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    fileSize = regularFile ? static_cast<size_t>(st.st_size) : 0;
+    for (auto &buffer : buffers) {
+      // Not value initialized, only the pages we read into get touched.
+      buffer.memory.reset(new char[reserve + chunkSize]);
+      buffer.chunk.data = buffer.memory.get() + reserve;
+    }
+    if (regularFile && readAheadMode() == ReadAheadMode::uring) {
+      try {
+        ring = std::make_unique<IoUring>(buffers.size());
+      } catch (const std::exception &) {
+        // Falls back to the thread.
+      }
+    }
+    if (ring) {
+      for (size_t i = 0; i < buffers.size(); ++i) {
+        buffers[i].chunkIndex = i;
+        submit(i);
+      }
+    } else {
+      reader = std::thread([this]() { readLoop(); });
+    }
+  }
+
+  ~ReadAhead() {
+    if (ring) {
+      // The kernel may still write into the buffers.
+      while (inFlight > 0) {
+        complete(ring->waitCompletion());
+      }
+    } else {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      changed.notify_all();
+      reader.join();
+    }
+  }
+
+  ReadAhead(const ReadAhead &) = delete;
+  ReadAhead &operator=(const ReadAhead &) = delete;
+
+  // The next chunk in file order, nullptr at the end. Blocks until it is
+  // read. It stays valid until it is released.
+  Chunk *acquire() {
+    Buffer &buffer = buffers[nextChunk % buffers.size()];
+    if (ring) {
+      if (buffer.state == State::free) {
+        return nullptr; // Past the end of the file, nothing was submitted.
+      }
+      while (buffer.state == State::reading) {
+        complete(ring->waitCompletion());
+      }
+    } else {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&]() { return buffer.state == State::ready; });
+    }
+    if (buffer.error != 0) {
+      throw std::runtime_error(std::string("Failed to read: ") +
+                               std::strerror(buffer.error));
+    }
+    if (buffer.chunk.size == 0) {
+      return nullptr;
+    }
+    ++nextChunk;
+    buffer.state = State::acquired;
+    return &buffer.chunk;
+  }
+
+  // Lets the buffer of the chunk be read into again.
+  void release(Chunk *chunk) {
+    const size_t index = std::find_if(buffers.begin(), buffers.end(),
+                                      [&](const Buffer &buffer) {
+                                        return &buffer.chunk == chunk;
+                                      }) -
+                         buffers.begin();
+    if (ring) {
+      buffers[index].state = State::free;
+      submit(index);
+    } else {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers[index].state = State::free;
+      }
+      changed.notify_all();
+    }
+  }
+
+private:
+  enum class State { free, reading, ready, acquired };
+
+  struct Buffer {
+    std::unique_ptr<char[]> memory;
+    Chunk chunk{nullptr, 0};
+    State state = State::free;
+    int error = 0;
+    // io_uring only: the chunk to read next, its file offset and the part
+    // still to read.
+    size_t chunkIndex = 0;
+    off_t offset = 0;
+    iovec iov{};
+  };
+
+  // Reads the next chunk assigned to the buffer, chunk i lives in buffer
+  // i % buffers.size(). The buffers may be released in any order.
+  void submit(size_t index) {
+    Buffer &buffer = buffers[index];
+    buffer.offset = static_cast<off_t>(buffer.chunkIndex * chunkSize);
+    buffer.chunkIndex += buffers.size();
+    if (static_cast<size_t>(buffer.offset) >= fileSize) {
+      return; // Stays free, acquire() reports the end.
+    }
+    buffer.chunk.size = 0;
+    buffer.iov.iov_base = buffer.chunk.data;
+    buffer.iov.iov_len =
+        std::min(chunkSize, fileSize - static_cast<size_t>(buffer.offset));
+    buffer.state = State::reading;
+    ring->submitRead(fd, &buffer.iov, buffer.offset, index);
+    ++inFlight;
+  }
+
+  void complete(const io_uring_cqe &cqe) {
+    --inFlight;
+    Buffer &buffer = buffers[cqe.user_data];
+    if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+      resubmit(buffer, cqe.user_data);
+    } else if (cqe.res < 0) {
+      buffer.error = -cqe.res;
+      buffer.state = State::ready;
+    } else if (cqe.res == 0 ||
+               static_cast<size_t>(cqe.res) == buffer.iov.iov_len) {
+      // Zero if the file got truncated meanwhile.
+      buffer.chunk.size += cqe.res;
+      buffer.state = State::ready;
+    } else {
+      // Short read, the rest has to follow in the same buffer.
+      buffer.chunk.size += cqe.res;
+      buffer.iov.iov_base = static_cast<char *>(buffer.iov.iov_base) + cqe.res;
+      buffer.iov.iov_len -= cqe.res;
+      resubmit(buffer, cqe.user_data);
+    }
+  }
+
+  void resubmit(Buffer &buffer, uint64_t index) {
+    ring->submitRead(fd, &buffer.iov,
+                     buffer.offset + static_cast<off_t>(buffer.chunk.size),
+                     index);
+    ++inFlight;
+  }
+
+  // Fills the chunks in order. Regular files are read with pread() up to the
+  // full chunk, pipes deliver whatever read() returns.
+  void readLoop() {
+    size_t offset = 0;
+    for (size_t chunkIndex = 0;; ++chunkIndex) {
+      Buffer &buffer = buffers[chunkIndex % buffers.size()];
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock,
+                     [&]() { return stop || buffer.state == State::free; });
+        if (stop) {
+          return;
+        }
+      }
+      size_t size = 0;
+      int error = 0;
+      while (size < chunkSize) {
+        const ssize_t n =
+            regularFile
+                ? ::pread(fd, buffer.chunk.data + size, chunkSize - size,
+                          static_cast<off_t>(offset + size))
+                : ::read(fd, buffer.chunk.data + size, chunkSize - size);
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n < 0) {
+          error = errno;
+          break;
+        }
+        size += n;
+        if (n == 0 || !regularFile) {
+          break;
+        }
+      }
+      offset += size;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.chunk.size = size;
+        buffer.error = error;
+        buffer.state = State::ready;
+      }
+      changed.notify_all();
+      if (size == 0 || error != 0) {
+        return;
+      }
+    }
+  }
+
+  int fd;
+  size_t chunkSize;
+  size_t reserve;
+  bool regularFile = false;
+  size_t fileSize = 0;
+  std::vector<Buffer> buffers;
+  size_t nextChunk = 0;
+  // io_uring
+  std::unique_ptr<IoUring> ring;
+  size_t inFlight = 0;
+  // Thread
+  std::thread reader;
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool stop = false;
+};
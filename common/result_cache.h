@@ -0,0 +1,199 @@
+#pragma once
+
+#include "format.h"
+#include "history.h"
+#include "input.h"
+#include "parse_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <elf.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <link.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Answers of earlier runs, so unchanged inputs don't have to be solved again.
+// Enabled with AOC_RESULT_CACHE=<path> (or the runner's --result-cache). The
+// file holds one JSON line per computed part, keyed by the group (i.e. the
+// day), the part name (including the implementation, e.g. "Part 1 [set]"
+// under --compare), a hash of the input's content and the build id of the
+// binary. Rebuilding or editing the input therefore never returns a stale
+// answer. Each line also keeps the time the part originally took.
+
+inline std::string toHex(uint64_t value) {
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buf;
+}
+
+// GNU build id of the executable, empty if it was linked without one.
+inline std::string readBuildId() {
+  std::string id;
+  ::dl_iterate_phdr(
+      [](dl_phdr_info *info, size_t, void *data) -> int {
+        auto &ret = *static_cast<std::string *>(data);
+        const auto align = [](size_t n) { return (n + 3) / 4 * 4; };
+        for (int i = 0; i < info->dlpi_phnum; ++i) {
+          const auto &phdr = info->dlpi_phdr[i];
+          if (phdr.p_type != PT_NOTE) {
+            continue;
+          }
+          const char *note =
+              reinterpret_cast<const char *>(info->dlpi_addr + phdr.p_vaddr);
+          const char *end = note + phdr.p_memsz;
+          while (note + sizeof(ElfW(Nhdr)) <= end) {
+            ElfW(Nhdr) header;
+            std::memcpy(&header, note, sizeof(header));
+            const char *name = note + sizeof(header);
+            const auto *desc = reinterpret_cast<const unsigned char *>(
+                name + align(header.n_namesz));
+            if (header.n_type == NT_GNU_BUILD_ID && header.n_namesz == 4 &&
+                std::memcmp(name, "GNU", 4) == 0) {
+              for (size_t j = 0; j < header.n_descsz; ++j) {
+                char buf[3];
+                std::snprintf(buf, sizeof(buf), "%02x", desc[j]);
+                ret += buf;
+              }
+              return 1;
+            }
+            note = reinterpret_cast<const char *>(desc) +
+                   align(header.n_descsz);
+          }
+        }
+        // The executable comes first, the shared libraries don't matter.
+        return 1;
+      },
+      &id);
+  return id;
+}
+
+// Identifies the binary. Falls back to a hash of the executable.
+inline const std::string &buildId() {
+  static const std::string id = [] {
+    std::string ret = readBuildId();
+    if (ret.empty()) {
+      const MappedFile exe("/proc/self/exe", true);
+      ret = "exe-" + toHex(hashBytes(exe.data()));
+    }
+    return ret;
+  }();
+  return id;
+}
+
+struct ResultKey {
+  std::string group;
+  std::string name;
+  std::string inputHash;
+  std::string buildId;
+
+  std::string str() const {
+    return group + '\0' + name + '\0' + inputHash + '\0' + buildId;
+  }
+};
+
+// Key of a part run on the current inputPath. None if there is no input.
+inline std::optional<ResultKey> resultKey(const std::string &group,
+                                          const std::string &name) {
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(inputPath, ec)) {
+    return std::nullopt;
+  }
+  const MappedFile input(inputPath);
+  return ResultKey{group, name, toHex(hashBytes(input.data())), buildId()};
+}
+
+struct CachedResult {
+  std::string time; // When it was computed, UTC.
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  std::string output;
+};
+
+class ResultCache {
+public:
+  explicit ResultCache(std::string path_) : path(std::move(path_)) {}
+
+  std::optional<CachedResult> find(const ResultKey &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    load();
+    const auto it = results.find(key.str());
+    if (it == results.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  void store(const ResultKey &key, const CachedResult &result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    load();
+    results[key.str()] = result;
+    std::ofstream ofs(path, std::ios::app);
+    // The output goes last, so the other keys can't be found inside it.
+    ofs << std::setprecision(9) << "{\"time\":\"" << jsonEscape(result.time)
+        << "\",\"group\":\"" << jsonEscape(key.group) << "\",\"name\":\""
+        << jsonEscape(key.name) << "\",\"input_hash\":\"" << key.inputHash
+        << "\",\"build_id\":\"" << key.buildId << "\",\"runs\":"
+        << result.runs << ",\"min_ms\":" << result.minMs
+        << ",\"median_ms\":" << result.medianMs
+        << ",\"mean_ms\":" << result.meanMs << ",\"output\":\""
+        << jsonEscape(result.output) << "\"}\n";
+  }
+
+private:
+  // Reads the file on first use. Later lines of the same key win.
+  void load() {
+    if (loaded) {
+      return;
+    }
+    loaded = true;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line)) {
+      // A line cut short, e.g. by a crash, might have half an answer.
+      if (line.empty() || line.back() != '}') {
+        continue;
+      }
+      const ResultKey key{jsonField(line, "group"), jsonField(line, "name"),
+                          jsonField(line, "input_hash"),
+                          jsonField(line, "build_id")};
+      CachedResult result;
+      result.time = jsonField(line, "time");
+      result.output = jsonField(line, "output");
+      try {
+        result.runs = std::stoi(jsonField(line, "runs"));
+        result.minMs = std::stod(jsonField(line, "min_ms"));
+        result.medianMs = std::stod(jsonField(line, "median_ms"));
+        result.meanMs = std::stod(jsonField(line, "mean_ms"));
+      } catch (const std::exception &) {
+        continue;
+      }
+      results[key.str()] = std::move(result);
+    }
+  }
+
+  std::mutex mutex;
+  std::string path;
+  bool loaded = false;
+  std::unordered_map<std::string, CachedResult> results;
+};
+
+// One cache per file for the whole process.
+inline ResultCache &resultCache(const std::string &path) {
+  static std::mutex mutex;
+  static std::map<std::string, std::unique_ptr<ResultCache>> caches;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &cache = caches[path];
+  if (!cache) {
+    cache = std::make_unique<ResultCache>(path);
+  }
+  return *cache;
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "alloc_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool shared by all days. Each worker owns a queue: it
+// pushes and pops its own tasks at the back, idle workers steal from the
+// front of the others. Threads outside the pool submit to a shared queue.
+// A thread waiting for a TaskGroup runs queued tasks of that group meanwhile,
+// so tasks may spawn and wait for tasks themselves without deadlocking, and a
+// day waiting for its tasks never runs the tasks of another day (the runner's
+// threads share queue 0).
+// AOC_THREADS=<n> sets the number of threads including the calling one
+// (default: configure(), else the number of cores). AOC_THREADS=1 runs
+// everything inline.
+// Tasks run on other threads, so they must neither print (the output of the
+// days is routed per thread, see bench.h) nor read inputPath. The heap
+// allocations of tasks that ran on other threads are added to the counters of
+// the waiting thread by TaskGroup::wait(). Hardware counters only count the
+// calling thread, tasksOnOtherThreads() tells whether that missed any work.
+
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  // numThreads includes the thread waiting for the results, so the pool
+  // starts one worker less.
+  explicit ThreadPool(size_t numThreads) {
+    numThreads = std::max<size_t>(1, numThreads);
+    // Queue 0 is the shared one.
+    for (size_t i = 0; i < numThreads; ++i) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 1; i < numThreads; ++i) {
+      workers.emplace_back([this, i]() { work(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  static ThreadPool &instance() {
+    static ThreadPool pool(defaultNumThreads());
+    return pool;
+  }
+
+  static size_t defaultNumThreads() {
+    if (const char *env = std::getenv("AOC_THREADS")) {
+      return std::max(1, std::atoi(env));
+    }
+    if (configuredThreads > 0) {
+      return configuredThreads;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Size of instance() unless AOC_THREADS is set. Only has an effect before
+  // the first use of instance(), e.g. the runner shrinks the pool when it
+  // runs several days at once, so both together don't oversubscribe the
+  // cores.
+  static void configure(size_t numThreads) {
+    configuredThreads = std::max<size_t>(1, numThreads);
+  }
+
+  // Number of tasks spawned by the calling thread (or by tasks it waited for)
+  // that ran on another thread, so far.
+  static size_t tasksOnOtherThreads() { return offloadedTasks; }
+
+  size_t numThreads() const { return queues.size(); }
+
+  // group only tags the task for runOne().
+  void submit(Task task, const void *group = nullptr) {
+    Queue &queue = *queues[queueIndex < queues.size() ? queueIndex : 0];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(Entry{std::move(task), group});
+    }
+    {
+      // Under the lock, so a worker can't miss it between checking and
+      // going to sleep.
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      ++pending;
+    }
+    wake.notify_one();
+  }
+
+  // Runs one queued task if there is any, preferring the own queue. With a
+  // group, only a task submitted with that group.
+  bool runOne(const void *group = nullptr) {
+    const size_t own = queueIndex < queues.size() ? queueIndex : 0;
+    Task task;
+    if (!popBack(*queues[own], group, task)) {
+      for (size_t i = 1; i < queues.size() && !task; ++i) {
+        stealFront(*queues[(own + i) % queues.size()], group, task);
+      }
+    }
+    if (!task) {
+      return false;
+    }
+    --pending;
+    task();
+    return true;
+  }
+
+private:
+  struct Entry {
+    Task task;
+    const void *group;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Entry> tasks;
+  };
+
+  static bool matches(const Entry &entry, const void *group) {
+    return !group || entry.group == group;
+  }
+
+  // The newest task (of group).
+  static bool popBack(Queue &queue, const void *group, Task &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto it = queue.tasks.rbegin(); it != queue.tasks.rend(); ++it) {
+      if (matches(*it, group)) {
+        task = std::move(it->task);
+        queue.tasks.erase(std::next(it).base());
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The oldest task (of group).
+  static bool stealFront(Queue &queue, const void *group, Task &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto it = queue.tasks.begin(); it != queue.tasks.end(); ++it) {
+      if (matches(*it, group)) {
+        task = std::move(it->task);
+        queue.tasks.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(size_t index) {
+    queueIndex = index;
+    while (true) {
+      if (runOne()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wake.wait(lock, [this]() { return stop || pending > 0; });
+      if (stop) {
+        return;
+      }
+    }
+  }
+
+  // Index of the current thread's queue, 0 for threads outside the pool.
+  static inline thread_local size_t queueIndex = 0;
+  static inline thread_local size_t offloadedTasks = 0;
+  static inline size_t configuredThreads = 0;
+
+  friend class TaskGroup;
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  std::atomic<size_t> pending{0};
+  bool stop = false;
+};
+
+// Tasks spawned into the pool and joined by wait(). The first exception
+// thrown by a task is rethrown by wait().
+class TaskGroup {
+public:
+  explicit TaskGroup(ThreadPool &pool_ = ThreadPool::instance())
+      : pool(pool_) {}
+
+  ~TaskGroup() {
+    try {
+      wait();
+    } catch (...) {
+    }
+  }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  template <typename Func> void spawn(Func func) {
+    ++outstanding;
+    pool.submit(
+        [this, func = std::move(func)]() mutable {
+          const bool elsewhere = std::this_thread::get_id() != owner;
+          const size_t offloadedBefore = ThreadPool::offloadedTasks;
+          // Not on the owner, whose running AllocScope would lose its peak.
+          std::optional<AllocScope> allocScope;
+          if (elsewhere) {
+            allocScope.emplace();
+          }
+          try {
+            func();
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+          if (elsewhere) {
+            // Handed to the owner by wait().
+            const AllocCounters allocs = allocScope->finish();
+            std::lock_guard<std::mutex> lock(mutex);
+            foreignAllocs.allocs += allocs.allocs;
+            foreignAllocs.frees += allocs.frees;
+            foreignAllocs.bytes += allocs.bytes;
+            foreignAllocs.liveBytes += allocs.liveBytes;
+            foreignAllocs.peakLiveBytes =
+                std::max(foreignAllocs.peakLiveBytes, allocs.peakLiveBytes);
+            foreignTasks += 1 + ThreadPool::offloadedTasks - offloadedBefore;
+          }
+          --outstanding;
+        },
+        this);
+  }
+
+  void wait() {
+    while (outstanding > 0) {
+      if (!pool.runOne(this)) {
+        std::this_thread::yield();
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      addForeignCounters();
+    }
+    if (error) {
+      std::rethrow_exception(std::exchange(error, nullptr));
+    }
+  }
+
+private:
+  // Adds what the tasks did on other threads to the counters of the owner.
+  // The peak is approximated by the largest peak of a single task on top of
+  // the owner's live bytes.
+  void addForeignCounters() {
+    allocCounters.allocs += foreignAllocs.allocs;
+    allocCounters.frees += foreignAllocs.frees;
+    allocCounters.bytes += foreignAllocs.bytes;
+    allocCounters.peakLiveBytes =
+        std::max(allocCounters.peakLiveBytes,
+                 allocCounters.liveBytes + foreignAllocs.peakLiveBytes);
+    allocCounters.liveBytes += foreignAllocs.liveBytes;
+    ThreadPool::offloadedTasks += foreignTasks;
+    foreignAllocs = AllocCounters();
+    foreignTasks = 0;
+  }
+
+  ThreadPool &pool;
+  const std::thread::id owner = std::this_thread::get_id();
+  std::atomic<size_t> outstanding{0};
+  std::mutex mutex;
+  std::exception_ptr error;
+  AllocCounters foreignAllocs;
+  size_t foreignTasks = 0;
+};
+
+// Calls body(i) for each i in [begin, end) on the pool. The threads grab
+// chunks of grain indices until none are left, which balances uneven
+// iterations. A grain of 0 picks about 8 chunks per thread.
+template <typename Func>
+void parallelFor(size_t begin, size_t end, Func body, size_t grain = 0,
+                 ThreadPool &pool = ThreadPool::instance()) {
+  if (begin >= end) {
+    return;
+  }
+  const size_t count = end - begin;
+  const size_t numThreads = pool.numThreads();
+  if (grain == 0) {
+    grain = std::max<size_t>(1, count / (numThreads * 8));
+  }
+  if (numThreads == 1 || count <= grain) {
+    for (size_t i = begin; i < end; ++i) {
+      body(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next{begin};
+  const auto work = [&]() {
+    for (size_t first = next.fetch_add(grain); first < end;
+         first = next.fetch_add(grain)) {
+      const size_t last = std::min(end, first + grain);
+      for (size_t i = first; i < last; ++i) {
+        body(i);
+      }
+    }
+  };
+  TaskGroup group(pool);
+  const size_t numTasks = std::min(numThreads, (count + grain - 1) / grain);
+  for (size_t i = 1; i < numTasks; ++i) {
+    group.spawn(work);
+  }
+  work();
+  group.wait();
+}
+
+// Combines map(i) for each i in [begin, end) with reduce, which must be
+// associative. The partial results of the chunks are combined in order, so
+// the result doesn't depend on the scheduling, not even for floating point.
+template <typename T, typename Map, typename Reduce>
+T parallelReduce(size_t begin, size_t end, T init, Map map, Reduce reduce,
+                 size_t grain = 0, ThreadPool &pool = ThreadPool::instance()) {
+  if (begin >= end) {
+    return init;
+  }
+  const size_t count = end - begin;
+  if (grain == 0) {
+    grain = std::max<size_t>(1, count / (pool.numThreads() * 8));
+  }
+  const size_t numChunks = (count + grain - 1) / grain;
+  std::vector<T> partials(numChunks);
+  parallelFor(
+      0, numChunks,
+      [&](size_t chunk) {
+        const size_t first = begin + chunk * grain;
+        const size_t last = std::min(end, first + grain);
+        T partial = map(first);
+        for (size_t i = first + 1; i < last; ++i) {
+          partial = reduce(std::move(partial), map(i));
+        }
+        partials[chunk] = std::move(partial);
+      },
+      1, pool);
+  for (auto &partial : partials) {
+    init = reduce(std::move(init), std::move(partial));
+  }
+  return init;
+}
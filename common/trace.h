@@ -0,0 +1,152 @@
+#pragma once
+
+#include "format.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+// Timeline of nested phases in the Chrome trace event format, which
+// Perfetto (ui.perfetto.dev) and chrome://tracing open. Enabled by
+// AOC_TRACE=<path> or --trace <path> in the runner, the trace is written when
+// the program exits. measureTime() records each run of a part, a day marks its
+// phases with ScopedTimer:
+//   {
+//     ScopedTimer timer("parse");
+//     ...
+//   }
+// While disabled a ScopedTimer only costs a branch.
+
+class TraceRecorder {
+public:
+  static TraceRecorder &instance() {
+    static TraceRecorder recorder;
+    return recorder;
+  }
+
+  bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+  void setOutput(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    outputPath = path;
+    active = !path.empty();
+  }
+
+  // Microseconds since the start of the program.
+  double nowUs() const {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start)
+        .count();
+  }
+
+  // Complete event of the calling thread.
+  void record(std::string_view name, std::string_view category,
+              double startUs, double endUs) {
+    const int tid = threadId();
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(
+        Event{std::string(name), std::string(category), tid, startUs,
+              endUs - startUs});
+  }
+
+  // Shown instead of the thread id in the trace viewer.
+  void setThreadName(const std::string &name) {
+    const int tid = threadId();
+    std::lock_guard<std::mutex> lock(mutex);
+    threadNames[tid] = name;
+  }
+
+  void write() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outputPath.empty()) {
+      return;
+    }
+    std::ofstream ofs(outputPath);
+    ofs << std::setprecision(12) << "{\"traceEvents\":[\n";
+    const int pid = static_cast<int>(::getpid());
+    const char *sep = "";
+    for (const auto &[tid, name] : threadNames) {
+      ofs << sep << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+          << ",\"tid\":" << tid << ",\"args\":{\"name\":\""
+          << jsonEscape(name) << "\"}}";
+      sep = ",\n";
+    }
+    for (const auto &event : events) {
+      ofs << sep << "{\"ph\":\"X\",\"name\":\"" << jsonEscape(event.name)
+          << "\",\"cat\":\"" << jsonEscape(event.category)
+          << "\",\"pid\":" << pid << ",\"tid\":" << event.tid
+          << ",\"ts\":" << event.startUs << ",\"dur\":" << event.durUs << "}";
+      sep = ",\n";
+    }
+    ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    std::string name;
+    std::string category;
+    int tid;
+    double startUs;
+    double durUs;
+  };
+
+  TraceRecorder() : start(Clock::now()) {
+    if (const char *env = std::getenv("AOC_TRACE")) {
+      setOutput(env);
+    }
+  }
+
+  ~TraceRecorder() { write(); }
+
+  // Small ids numbered in order of the first event, unlike the system ids.
+  static int threadId() {
+    static std::atomic<int> nextId{1};
+    static thread_local const int id = nextId++;
+    return id;
+  }
+
+  const Clock::time_point start;
+  std::atomic<bool> active{false};
+  std::mutex mutex;
+  std::string outputPath;
+  std::vector<Event> events;
+  std::map<int, std::string> threadNames;
+};
+
+// Records the time from construction to destruction as one event.
+class ScopedTimer {
+public:
+  explicit ScopedTimer(std::string_view name_,
+                       std::string_view category_ = "phase")
+      : recorder(TraceRecorder::instance()) {
+    if (recorder.enabled()) {
+      name = name_;
+      category = category_;
+      startUs = recorder.nowUs();
+    }
+  }
+
+  ~ScopedTimer() {
+    if (startUs >= 0.0) {
+      recorder.record(name, category, startUs, recorder.nowUs());
+    }
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  TraceRecorder &recorder;
+  // Copies, so the timer may outlive temporary names.
+  std::string name;
+  std::string category;
+  double startUs = -1.0;
+};
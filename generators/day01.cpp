@@ -0,0 +1,27 @@
+#include "generators.h"
+
+// Lines of letters with digits and spelled out digits mixed in. Every line
+// contains at least one actual digit.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  static const std::string words[] = {"one", "two",   "three", "four", "five",
+                                      "six", "seven", "eight", "nine"};
+  const size_t numLines = scaled(1000, scale);
+  for (size_t i = 0; i < numLines; ++i) {
+    std::string line;
+    const int numTokens = randomInt(rng, 1, 6);
+    const int digitToken = randomInt(rng, 0, numTokens - 1);
+    for (int t = 0; t < numTokens; ++t) {
+      for (int n = randomInt(rng, 0, 4); n > 0; --n) {
+        line += static_cast<char>('a' + randomInt(rng, 0, 25));
+      }
+      if (t == digitToken || randomChance(rng, 0.3)) {
+        line += static_cast<char>('1' + randomInt(rng, 0, 8));
+      } else {
+        line += words[randomInt(rng, 0, 8)];
+      }
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(1, &generate);
@@ -0,0 +1,23 @@
+#include "generators.h"
+
+// Games with a few draws of up to three colors each.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  static const std::string colors[] = {"red", "green", "blue"};
+  const size_t numGames = scaled(100, scale);
+  for (size_t game = 1; game <= numGames; ++game) {
+    os << "Game " << game << ":";
+    const int numDraws = randomInt(rng, 1, 6);
+    for (int d = 0; d < numDraws; ++d) {
+      int order[] = {0, 1, 2};
+      std::shuffle(std::begin(order), std::end(order), rng);
+      const int numColors = randomInt(rng, 1, 3);
+      for (int c = 0; c < numColors; ++c) {
+        os << (c == 0 ? " " : ", ") << randomInt(rng, 1, 20) << " "
+           << colors[order[c]];
+      }
+      os << (d + 1 < numDraws ? ";" : "\n");
+    }
+  }
+}
+
+static const GeneratorRegistrar registrar(2, &generate);
@@ -0,0 +1,25 @@
+#include "generators.h"
+
+// Schematic of 140 columns with numbers and symbols on a '.' background.
+// Rows grow with the scale. Numbers are separated by at least one '.'.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int cols = 140;
+  const size_t rows = scaled(140, scale);
+  for (size_t row = 0; row < rows; ++row) {
+    std::string line(cols, '.');
+    for (int col = 0; col < cols; ++col) {
+      if (randomChance(rng, 0.06)) {
+        const int digits = std::min(randomInt(rng, 1, 3), cols - col);
+        for (int d = 0; d < digits; ++d) {
+          line[col + d] = static_cast<char>('0' + randomInt(rng, d == 0 ? 1 : 0, 9));
+        }
+        col += digits;
+      } else if (randomChance(rng, 0.04)) {
+        line[col] = randomChar(rng, "*#+$/@%=&-");
+      }
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(3, &generate);
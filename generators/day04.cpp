@@ -0,0 +1,36 @@
+#include "generators.h"
+#include <cstdio>
+#include <numeric>
+
+// Cards with 10 winning and 25 drawn numbers out of 1..99. Most cards have
+// few matches so that the number of copies stays reasonable.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numCards = scaled(192, scale);
+  std::vector<int> numbers(99);
+  std::iota(numbers.begin(), numbers.end(), 1);
+  char buffer[32];
+  for (size_t card = 1; card <= numCards; ++card) {
+    std::shuffle(numbers.begin(), numbers.end(), rng);
+    // The first 10 numbers win. Draw matches of them and 25 - matches others,
+    // 25 numbers in total.
+    const int matches = randomChance(rng, 0.5) ? 0 : randomInt(rng, 1, 10);
+    std::vector<int> drawn(numbers.begin(), numbers.begin() + matches);
+    drawn.insert(drawn.end(), numbers.begin() + 10,
+                 numbers.begin() + 35 - matches);
+    std::shuffle(drawn.begin(), drawn.end(), rng);
+    std::snprintf(buffer, sizeof(buffer), "Card %3zu:", card);
+    os << buffer;
+    for (int i = 0; i < 10; ++i) {
+      std::snprintf(buffer, sizeof(buffer), " %2d", numbers[i]);
+      os << buffer;
+    }
+    os << " |";
+    for (const int n : drawn) {
+      std::snprintf(buffer, sizeof(buffer), " %2d", n);
+      os << buffer;
+    }
+    os << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(4, &generate);
@@ -0,0 +1,42 @@
+#include "generators.h"
+
+// Seed ranges and seven maps, each made of non-overlapping source ranges
+// within [0, 2^32). Both the number of seeds and of map entries grow with the
+// scale.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  static const std::string names[] = {
+      "seed-to-soil",         "soil-to-fertilizer",
+      "fertilizer-to-water",  "water-to-light",
+      "light-to-temperature", "temperature-to-humidity",
+      "humidity-to-location"};
+  constexpr long long limit = 1LL << 32;
+  const size_t numSeedRanges = scaled(10, scale);
+  os << "seeds:";
+  for (size_t i = 0; i < numSeedRanges; ++i) {
+    const long long start = randomInt(rng, 0LL, limit - 2);
+    os << " " << start << " "
+       << randomInt(rng, 1LL, std::min(limit - start - 1, 400'000'000LL));
+  }
+  os << "\n";
+  for (const auto &name : names) {
+    os << "\n" << name << " map:\n";
+    const size_t numEntries = scaled(40, scale);
+    // Split [0, 2^32) at random points and map most of the pieces.
+    std::vector<long long> bounds{0, limit};
+    for (size_t i = 0; i < numEntries; ++i) {
+      bounds.push_back(randomInt(rng, 1LL, limit - 1));
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+      if (randomChance(rng, 0.1)) {
+        continue; // Not mapped.
+      }
+      const long long length = bounds[i + 1] - bounds[i];
+      os << randomInt(rng, 0LL, limit - length) << " " << bounds[i] << " "
+         << length << "\n";
+    }
+  }
+}
+
+static const GeneratorRegistrar registrar(5, &generate);
@@ -0,0 +1,23 @@
+#include "generators.h"
+#include <cstdio>
+
+// Races with a record distance that can be beaten. The number of races grows
+// with the scale. Part 2 uses hardcoded values and ignores the input.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numRaces = scaled(4, scale);
+  std::string times = "Time:    ";
+  std::string distances = "Distance:";
+  char buffer[32];
+  for (size_t i = 0; i < numRaces; ++i) {
+    const int time = randomInt(rng, 10, 99);
+    // Holding the button for half the time goes time^2 / 4.
+    const int record = randomInt(rng, time, time * time / 4 - 1);
+    std::snprintf(buffer, sizeof(buffer), " %6d", time);
+    times += buffer;
+    std::snprintf(buffer, sizeof(buffer), " %6d", record);
+    distances += buffer;
+  }
+  os << times << "\n" << distances << "\n";
+}
+
+static const GeneratorRegistrar registrar(6, &generate);
@@ -0,0 +1,18 @@
+#include "generators.h"
+
+// Hands of five cards with a bid each.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numHands = scaled(1000, scale);
+  for (size_t i = 0; i < numHands; ++i) {
+    std::string hand(5, ' ');
+    // Reuse earlier cards now and then to get pairs, full houses, etc.
+    for (int c = 0; c < 5; ++c) {
+      hand[c] = (c > 0 && randomChance(rng, 0.3))
+                    ? hand[randomInt(rng, 0, c - 1)]
+                    : randomChar(rng, "23456789TJQKA");
+    }
+    os << hand << " " << randomInt(rng, 1, 1000) << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(7, &generate);
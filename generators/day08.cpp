@@ -0,0 +1,63 @@
+#include "generators.h"
+
+// Network of one cycle per ghost, like in the real inputs: Walking from a
+// start node (ending on A) reaches its end node (ending on Z) after p times
+// the length of the instructions for a small prime p, and again every such
+// period after that. Both the instructions and the cycles grow with the scale.
+// The first ghost walks from AAA to ZZZ for part 1.
+
+// Name of `width` characters: the number in base 26 followed by `last`.
+static std::string makeName(size_t number, size_t width, char last) {
+  std::string name(width, last);
+  for (size_t i = width - 1; i-- > 0;) {
+    name[i] = static_cast<char>('A' + number % 26);
+    number /= 26;
+  }
+  return name;
+}
+
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  static const int primes[] = {2, 3, 5, 7, 11, 13};
+  const size_t inputSize = std::max<size_t>(2, scaled(18, scale));
+  size_t numNodes = 0;
+  for (const int p : primes) {
+    numNodes += p * inputSize;
+  }
+  // Intermediate nodes end on B..Y, so 24 names per prefix.
+  size_t width = 3;
+  while (std::pow(26.0, width - 1) * 24 < numNodes) {
+    ++width;
+  }
+  for (size_t i = 0; i < inputSize; ++i) {
+    os << (randomChance(rng, 0.5) ? 'L' : 'R');
+  }
+  os << "\n\n";
+  std::vector<std::string> lines;
+  size_t nextIntermediate = 0;
+  const auto intermediate = [&]() {
+    const size_t n = nextIntermediate++;
+    return makeName(n / 24, width, static_cast<char>('B' + n % 24));
+  };
+  for (size_t ghost = 0; ghost < std::size(primes); ++ghost) {
+    const size_t period = primes[ghost] * inputSize;
+    const std::string start =
+        ghost == 0 ? "AAA" : makeName(ghost, width, 'A');
+    const std::string end = ghost == 0 ? "ZZZ" : makeName(ghost, width, 'Z');
+    const std::string first = intermediate();
+    lines.push_back(start + " = (" + first + ", " + first + ")");
+    std::string cur = first;
+    for (size_t i = 2; i < period; ++i) {
+      const std::string next = intermediate();
+      lines.push_back(cur + " = (" + next + ", " + next + ")");
+      cur = next;
+    }
+    lines.push_back(cur + " = (" + end + ", " + end + ")");
+    lines.push_back(end + " = (" + first + ", " + first + ")");
+  }
+  std::shuffle(lines.begin(), lines.end(), rng);
+  for (const auto &line : lines) {
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(8, &generate);
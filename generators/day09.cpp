@@ -0,0 +1,27 @@
+#include "generators.h"
+
+// Sequences of 21 values of polynomials up to degree 6, built from random
+// initial values of the difference rows.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  constexpr int length = 21;
+  const size_t numLines = scaled(200, scale);
+  for (size_t i = 0; i < numLines; ++i) {
+    const int degree = randomInt(rng, 0, 6);
+    // Start with the constant row and integrate it degree times.
+    std::vector<long long> values(length, randomInt(rng, -5, 5));
+    for (int d = 0; d < degree; ++d) {
+      long long value = randomInt(rng, -10, 10);
+      for (auto &v : values) {
+        const long long diff = v;
+        v = value;
+        value += diff;
+      }
+    }
+    for (int v = 0; v < length; ++v) {
+      os << (v == 0 ? "" : " ") << values[v];
+    }
+    os << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(9, &generate);
@@ -0,0 +1,79 @@
+#include "generators.h"
+
+// A closed loop snaking through the grid in columns of random depth, starting
+// at S in the top left corner. Everything else is random pipes and ground.
+
+using Cell = std::pair<int, int>; // Row, col
+
+// Pipe connecting the two neighbours of a loop cell.
+static char pipeFor(const Cell &cell, const Cell &a, const Cell &b) {
+  const auto connects = [&](int dRow, int dCol) {
+    const Cell n{cell.first + dRow, cell.second + dCol};
+    return n == a || n == b;
+  };
+  const bool up = connects(-1, 0), down = connects(1, 0);
+  const bool left = connects(0, -1), right = connects(0, 1);
+  if (up && down) {
+    return '|';
+  } else if (left && right) {
+    return '-';
+  } else if (up && right) {
+    return 'L';
+  } else if (up && left) {
+    return 'J';
+  } else if (down && left) {
+    return '7';
+  }
+  return 'F';
+}
+
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int side = std::max(8, scaledSide(140, scale));
+  std::vector<std::string> grid(side, std::string(side, '.'));
+  for (auto &line : grid) {
+    for (auto &ch : line) {
+      ch = randomChar(rng, "|-LJ7F...");
+    }
+  }
+  // Loop: Along the top row to the right, then alternately down and up the
+  // columns from right to left, and finally up the leftmost column.
+  const int top = 1, bottom = side - 2, left = 1;
+  int right = side - 2;
+  if ((right - left) % 2 == 0) {
+    --right;
+  }
+  std::vector<Cell> loop;
+  for (int col = left; col <= right; ++col) {
+    loop.emplace_back(top, col);
+  }
+  int row = top;
+  for (int col = right; col > left; --col) {
+    const bool down = (right - col) % 2 == 0;
+    const int target = down ? randomInt(rng, (top + bottom) / 2 + 1, bottom)
+                            : randomInt(rng, top + 1, (top + bottom) / 2);
+    if (col != right) {
+      loop.emplace_back(row, col);
+    }
+    while (row != target) {
+      row += down ? 1 : -1;
+      loop.emplace_back(row, col);
+    }
+  }
+  while (row > top) {
+    loop.emplace_back(row--, left);
+  }
+  for (size_t i = 0; i < loop.size(); ++i) {
+    const Cell &prev = loop[(i + loop.size() - 1) % loop.size()];
+    const Cell &next = loop[(i + 1) % loop.size()];
+    grid[loop[i].first][loop[i].second] = pipeFor(loop[i], prev, next);
+  }
+  // Neighbours of S that are not part of the loop must not connect to it.
+  grid[top][left] = 'S';
+  grid[top - 1][left] = '.';
+  grid[top][left - 1] = '.';
+  for (const auto &line : grid) {
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(10, &generate);
@@ -0,0 +1,22 @@
+#include "generators.h"
+
+// Square image with sparse galaxies and some empty rows and columns.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int side = scaledSide(140, scale);
+  std::vector<bool> emptyRows(side), emptyCols(side);
+  for (int i = 0; i < side; ++i) {
+    emptyRows[i] = randomChance(rng, 0.05);
+    emptyCols[i] = randomChance(rng, 0.05);
+  }
+  for (int row = 0; row < side; ++row) {
+    std::string line(side, '.');
+    for (int col = 0; col < side && !emptyRows[row]; ++col) {
+      if (!emptyCols[col] && randomChance(rng, 0.022)) {
+        line[col] = '#';
+      }
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(11, &generate);
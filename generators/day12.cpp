@@ -0,0 +1,32 @@
+#include "generators.h"
+
+// Records of springs. A random row of operational (.) and damaged (#) springs
+// gives the group sizes, then some springs are hidden behind '?'.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numLines = scaled(1000, scale);
+  for (size_t i = 0; i < numLines; ++i) {
+    std::string springs(randomInt(rng, 3, 20), '.');
+    for (auto &ch : springs) {
+      ch = randomChance(rng, 0.5) ? '#' : '.';
+    }
+    springs[randomInt<size_t>(rng, 0, springs.size() - 1)] = '#';
+    std::string groups;
+    int groupSize = 0;
+    for (size_t s = 0; s <= springs.size(); ++s) {
+      if (s < springs.size() && springs[s] == '#') {
+        ++groupSize;
+      } else if (groupSize > 0) {
+        groups += (groups.empty() ? "" : ",") + std::to_string(groupSize);
+        groupSize = 0;
+      }
+    }
+    for (auto &ch : springs) {
+      if (randomChance(rng, 0.5)) {
+        ch = '?';
+      }
+    }
+    os << springs << " " << groups << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(12, &generate);
@@ -0,0 +1,40 @@
+#include "generators.h"
+
+// Patterns with a perfect vertical reflection and a horizontal reflection
+// with exactly one smudge, so both parts find a reflection in every pattern.
+// The smudge is placed in the columns right of the vertical reflection's
+// range, so it doesn't break the perfect one.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numPatterns = scaled(100, scale);
+  for (size_t p = 0; p < numPatterns; ++p) {
+    const int rows = randomInt(rng, 5, 17);
+    const int cols = randomInt(rng, 5, 17);
+    // Columns [0, 2 * halfCols) and rows [0, 2 * halfRows) are mirrored.
+    const int halfCols = randomInt(rng, 1, (cols - 1) / 2);
+    const int halfRows = randomInt(rng, 1, rows / 2);
+    std::vector<std::string> pattern(rows, std::string(cols, '.'));
+    for (int row = 0; row < rows; ++row) {
+      if (row >= halfRows && row < 2 * halfRows) {
+        pattern[row] = pattern[2 * halfRows - 1 - row];
+        continue;
+      }
+      for (int col = 0; col < cols; ++col) {
+        pattern[row][col] =
+            col < 2 * halfCols && col >= halfCols
+                ? pattern[row][2 * halfCols - 1 - col]
+                : (randomChance(rng, 0.5) ? '#' : '.');
+      }
+    }
+    char &smudge = pattern[randomInt(rng, 0, halfRows - 1)]
+                          [randomInt(rng, 2 * halfCols, cols - 1)];
+    smudge = (smudge == '#') ? '.' : '#';
+    if (p > 0) {
+      os << "\n";
+    }
+    for (const auto &line : pattern) {
+      os << line << "\n";
+    }
+  }
+}
+
+static const GeneratorRegistrar registrar(13, &generate);
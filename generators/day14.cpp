@@ -0,0 +1,15 @@
+#include "generators.h"
+
+// Square platform of round rocks (O), cube rocks (#) and empty space.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int side = scaledSide(100, scale);
+  for (int row = 0; row < side; ++row) {
+    std::string line(side, '.');
+    for (auto &ch : line) {
+      ch = randomChar(rng, "OO##......");
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(14, &generate);
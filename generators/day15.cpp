@@ -0,0 +1,25 @@
+#include "generators.h"
+
+// One line of comma separated steps. Labels are drawn from a pool, so lenses
+// get replaced and removed.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numSteps = scaled(4000, scale);
+  std::vector<std::string> labels(std::max<size_t>(1, numSteps / 8));
+  for (auto &label : labels) {
+    for (int n = randomInt(rng, 2, 6); n > 0; --n) {
+      label += static_cast<char>('a' + randomInt(rng, 0, 25));
+    }
+  }
+  for (size_t i = 0; i < numSteps; ++i) {
+    os << (i == 0 ? "" : ",")
+       << labels[randomInt<size_t>(rng, 0, labels.size() - 1)];
+    if (randomChance(rng, 0.7)) {
+      os << "=" << randomInt(rng, 1, 9);
+    } else {
+      os << "-";
+    }
+  }
+  os << "\n";
+}
+
+static const GeneratorRegistrar registrar(15, &generate);
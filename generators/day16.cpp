@@ -0,0 +1,17 @@
+#include "generators.h"
+
+// Square contraption, mostly empty space with mirrors and splitters.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int side = scaledSide(110, scale);
+  for (int row = 0; row < side; ++row) {
+    std::string line(side, '.');
+    for (auto &ch : line) {
+      if (randomChance(rng, 0.1)) {
+        ch = randomChar(rng, "/\\|-");
+      }
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(16, &generate);
@@ -0,0 +1,15 @@
+#include "generators.h"
+
+// Square map of heat loss digits 1..9.
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const int side = scaledSide(141, scale);
+  for (int row = 0; row < side; ++row) {
+    std::string line(side, '1');
+    for (auto &ch : line) {
+      ch = static_cast<char>('0' + randomInt(rng, 1, 9));
+    }
+    os << line << "\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(17, &generate);
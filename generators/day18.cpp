@@ -0,0 +1,54 @@
+#include "generators.h"
+#include <cstdio>
+
+// Dig plans of simple rectilinear polygons. Each polygon has a flat bottom
+// and a top edge made of steps of random width and height, so it can't
+// intersect itself. The plain directions describe one polygon for part 1,
+// the hex codes a much larger one for part 2.
+
+struct Move {
+  char dir;
+  long long steps;
+};
+
+static std::vector<Move> makePolygon(size_t numSteps, long long maxHeight,
+                                     long long maxWidth, Rng &rng) {
+  std::vector<Move> moves;
+  std::vector<long long> heights(numSteps);
+  long long width = 0;
+  for (size_t i = 0; i < numSteps; ++i) {
+    do {
+      heights[i] = randomInt(rng, 1LL, maxHeight);
+    } while (i > 0 && heights[i] == heights[i - 1]);
+    if (i > 0) {
+      const long long diff = heights[i] - heights[i - 1];
+      moves.push_back(Move{diff > 0 ? 'U' : 'D', std::abs(diff)});
+    }
+    const long long stepWidth = randomInt(rng, 1LL, maxWidth);
+    moves.push_back(Move{'R', stepWidth});
+    width += stepWidth;
+  }
+  moves.push_back(Move{'D', heights.back()});
+  moves.push_back(Move{'L', width});
+  moves.push_back(Move{'U', heights.front()});
+  return moves;
+}
+
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numSteps = scaled(328, scale);
+  const auto plan1 = makePolygon(numSteps, 10, 10, rng);
+  // The hex codes have 5 digits for the steps, which limits the bottom edge.
+  constexpr long long maxSteps = 0xfffff;
+  const auto plan2 = makePolygon(
+      numSteps, maxSteps,
+      std::max<long long>(1, maxSteps / static_cast<long long>(numSteps)), rng);
+  const std::string hexDirs = "RDLU";
+  char buffer[16];
+  for (size_t i = 0; i < plan1.size(); ++i) {
+    std::snprintf(buffer, sizeof(buffer), "%05llx%c", plan2[i].steps,
+                  static_cast<char>('0' + hexDirs.find(plan2[i].dir)));
+    os << plan1[i].dir << " " << plan1[i].steps << " (#" << buffer << ")\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(18, &generate);
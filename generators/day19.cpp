@@ -0,0 +1,58 @@
+#include "generators.h"
+
+// Workflows and parts. Rules only send parts to workflows further down the
+// list (or accept / reject them), so every part ends up accepted or rejected.
+// The first workflow is "in".
+
+// Base 26 digits of the number, least significant first.
+static std::string makeName(size_t number) {
+  std::string name;
+  do {
+    name += static_cast<char>('a' + number % 26);
+    number /= 26;
+  } while (number > 0);
+  return name;
+}
+
+static void generate(std::ostream &os, double scale, Rng &rng) {
+  const size_t numWorkflows = scaled(570, scale);
+  const size_t numParts = scaled(200, scale);
+  std::vector<std::string> names(numWorkflows);
+  names[0] = "in";
+  for (size_t i = 1; i < numWorkflows; ++i) {
+    // At least two letters, like in the real inputs. The number that would
+    // give "in" is replaced by one that isn't used otherwise.
+    names[i] = makeName(i + 26);
+    if (names[i] == "in") {
+      names[i] = makeName(numWorkflows + 26);
+    }
+  }
+  const auto target = [&](size_t from) -> std::string {
+    if (from + 1 >= numWorkflows || randomChance(rng, 0.3)) {
+      return randomChance(rng, 0.5) ? "A" : "R";
+    }
+    return names[randomInt(rng, from + 1, numWorkflows - 1)];
+  };
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < numWorkflows; ++i) {
+    std::string line = names[i] + "{";
+    for (int r = randomInt(rng, 1, 4); r > 0; --r) {
+      line += randomChar(rng, "xmas");
+      line += randomChar(rng, "<>");
+      line += std::to_string(randomInt(rng, 1, 4000)) + ":" + target(i) + ",";
+    }
+    lines.push_back(line + target(i) + "}");
+  }
+  std::shuffle(lines.begin() + 1, lines.end(), rng);
+  for (const auto &line : lines) {
+    os << line << "\n";
+  }
+  os << "\n";
+  for (size_t i = 0; i < numParts; ++i) {
+    os << "{x=" << randomInt(rng, 1, 4000) << ",m=" << randomInt(rng, 1, 4000)
+       << ",a=" << randomInt(rng, 1, 4000) << ",s=" << randomInt(rng, 1, 4000)
+       << "}\n";
+  }
+}
+
+static const GeneratorRegistrar registrar(19, &generate);
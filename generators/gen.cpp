@@ -0,0 +1,61 @@
+#include "generators.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Writes a synthetic input for a day.
+// Usage: ./gen <day> [--scale <s>] [--seed <n>] [--output <path>]
+// Scale 1 is about the size of the bundled input.txt. Without --output the
+// input is written to stdout.
+
+void printUsage() {
+  std::cerr << "Usage: gen <day> [--scale <s>] [--seed <n>] "
+               "[--output <path>]\n";
+}
+
+int main(int argc, char *argv[]) {
+  int day = 0;
+  double scale = 1.0;
+  unsigned long long seed = 1;
+  std::string outputPath;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const auto nextArg = [&]() -> std::string {
+        if (i + 1 >= argc) {
+          throw std::runtime_error("Missing value for " + arg + ".");
+        }
+        return argv[++i];
+      };
+      if (arg == "--scale") {
+        scale = std::stod(nextArg());
+      } else if (arg == "--seed") {
+        seed = std::stoull(nextArg());
+      } else if (arg == "--output") {
+        outputPath = nextArg();
+      } else if (arg == "-h" || arg == "--help") {
+        printUsage();
+        return 0;
+      } else {
+        day = std::stoi(arg);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    printUsage();
+    return 1;
+  }
+  const Generator *generator = findGenerator(day);
+  if (!generator || scale <= 0.0) {
+    printUsage();
+    return 1;
+  }
+  Rng rng(seed);
+  if (outputPath.empty()) {
+    generator->func(std::cout, scale, rng);
+  } else {
+    std::ofstream ofs(outputPath);
+    generator->func(ofs, scale, rng);
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic puzzle inputs. Each day registers a generator that writes a valid
+// input of about `scale` times the size of the bundled input.txt. The same
+// seed and scale always give the same input.
+using Rng = std::mt19937_64;
+using GeneratorFunc = void (*)(std::ostream &os, double scale, Rng &rng);
+
+struct Generator {
+  int day;
+  GeneratorFunc func;
+};
+
+inline std::vector<Generator> &generators() {
+  static std::vector<Generator> gens;
+  return gens;
+}
+
+inline const Generator *findGenerator(int day) {
+  const auto &gens = generators();
+  const auto it = std::find_if(gens.begin(), gens.end(),
+                               [day](const Generator &g) { return g.day == day; });
+  return it == gens.end() ? nullptr : &*it;
+}
+
+// Each generator's translation unit registers itself with a static instance.
+struct GeneratorRegistrar {
+  GeneratorRegistrar(int day, GeneratorFunc func) {
+    generators().push_back(Generator{day, func});
+  }
+};
+
+// Uniformly distributed in [lo, hi].
+template <typename T> T randomInt(Rng &rng, T lo, T hi) {
+  return std::uniform_int_distribution<T>(lo, hi)(rng);
+}
+
+inline bool randomChance(Rng &rng, double probability) {
+  return std::bernoulli_distribution(probability)(rng);
+}
+
+inline char randomChar(Rng &rng, const std::string &chars) {
+  return chars[randomInt<size_t>(rng, 0, chars.size() - 1)];
+}
+
+// Number of items (lines, steps, ...) for a scale, at least 1.
+inline size_t scaled(double base, double scale) {
+  return std::max<size_t>(1, static_cast<size_t>(std::llround(base * scale)));
+}
+
+// Side length of a square grid with `scale` times the cells of a base grid.
+inline int scaledSide(int base, double scale) {
+  return std::max(1, static_cast<int>(std::lround(base * std::sqrt(scale))));
+}
@@ -0,0 +1,34 @@
+#include "batch.h"
+#include "../common/batch.h"
+#include <map>
+#include <stdexcept>
+
+bool runBatchInputs(const std::vector<Job> &jobs, bool daysSelected,
+                    const std::string &source, unsigned int numThreads) {
+  std::map<int, std::vector<BatchPart>> parts;
+  for (const auto &job : jobs) {
+    auto &dayParts = parts[job.day->number];
+    for (const auto &part : job.day->parts) {
+      dayParts.push_back(BatchPart{part.name, part.func});
+    }
+  }
+  std::vector<BatchTask> tasks;
+  for (const auto &input : loadBatch(source)) {
+    if (input.day > 0) {
+      const auto it = parts.find(input.day);
+      if (it == parts.end()) {
+        throw std::runtime_error("Day " + std::to_string(input.day) +
+                                 " of " + input.path + " is not selected.");
+      }
+      tasks.push_back(BatchTask{input.path, input.day, &it->second});
+    } else if (!daysSelected) {
+      // Running every day on an input of unknown day is hardly intended.
+      throw std::runtime_error("No day given for " + input.path + ".");
+    } else {
+      for (const auto &[day, dayParts] : parts) {
+        tasks.push_back(BatchTask{input.path, day, &dayParts});
+      }
+    }
+  }
+  return runBatch(tasks, numThreads);
+}
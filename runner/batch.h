@@ -0,0 +1,12 @@
+#pragma once
+
+#include "job.h"
+#include <string>
+#include <vector>
+
+// Solves the inputs of a batch directory or manifest (see common/batch.h)
+// concurrently on the given number of threads. An input is solved by the day
+// given for it in the manifest, otherwise by each of the selected days.
+// Returns false if any part failed.
+bool runBatchInputs(const std::vector<Job> &jobs, bool daysSelected,
+                    const std::string &source, unsigned int numThreads);
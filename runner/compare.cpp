@@ -0,0 +1,78 @@
+#include "compare.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct Candidate {
+  std::string name;
+  const std::function<void()> *func;
+};
+
+// The reference first, then the implementation the day runs by default, then
+// the other alternatives.
+std::vector<Candidate> candidates(const Part &part) {
+  std::vector<Candidate> ret;
+  ret.push_back({part.alternatives[0].name, &part.alternatives[0].func});
+  ret.push_back({"default", &part.func});
+  for (size_t i = 1; i < part.alternatives.size(); ++i) {
+    ret.push_back({part.alternatives[i].name, &part.alternatives[i].func});
+  }
+  return ret;
+}
+
+} // namespace
+
+bool runCompare(std::vector<Job> &jobs, const std::filesystem::path &root) {
+  std::ostringstream oss;
+  oss << std::left << std::setw(5) << "Day" << std::setw(12) << "Part"
+      << std::setw(22) << "Implementation" << std::right << std::setw(12)
+      << "Median" << std::setw(9) << "Speedup" << "  Answer\n";
+  bool agree = true;
+  for (auto &job : jobs) {
+    const std::string dir = std::to_string(job.day->number);
+    inputPath = (root / dir / "input.txt").string();
+    benchGroup = "Day " + dir;
+    benchCollector = &job.stats;
+    // The output of the days only ends up in the stats.
+    ScopedOutput output(&job.output, false);
+    for (const auto &part : job.day->parts) {
+      if (part.alternatives.empty()) {
+        continue;
+      }
+      const size_t first = job.stats.size();
+      try {
+        for (const auto &candidate : candidates(part)) {
+          measureTime(*candidate.func,
+                      part.name + " [" + candidate.name + "]");
+        }
+      } catch (const std::exception &e) {
+        oss << std::left << std::setw(5) << job.day->number << "Failed: "
+            << e.what() << "\n";
+        agree = false;
+        continue;
+      }
+      const BenchStats &reference = job.stats[first];
+      const auto names = candidates(part);
+      for (size_t i = 0; i < names.size(); ++i) {
+        const BenchStats &stats = job.stats[first + i];
+        oss << std::left << std::setw(5) << job.day->number << std::setw(12)
+            << part.name << std::setw(22) << names[i].name << std::right
+            << std::setw(12) << formatDuration(stats.medianMs) << std::setw(8)
+            << std::fixed << std::setprecision(2)
+            << reference.medianMs / std::max(stats.medianMs, 1e-9) << "x"
+            << std::defaultfloat << "  " << summarizeOutput(stats.output);
+        if (stats.output != reference.output) {
+          oss << "  MISMATCH";
+          agree = false;
+        }
+        oss << "\n";
+      }
+    }
+    benchCollector = nullptr;
+  }
+  std::cout << oss.str();
+  return agree;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "job.h"
+#include <filesystem>
+#include <vector>
+
+// Runs every implementation of the parts that have alternatives on the day's
+// input, checks that they print the same as the reference and reports their
+// speedups relative to it. Returns false if any of them disagrees.
+bool runCompare(std::vector<Job> &jobs, const std::filesystem::path &root);
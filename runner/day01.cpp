@@ -0,0 +1,11 @@
+#include "prelude.h"
+
+namespace day01 {
+#include "../1/solve.cpp"
+}
+
+static const DayRegistrar
+    registrar(1, {{"Part 1", &day01::solvePart1},
+                  {"Part 2",
+                   &day01::solvePart2,
+                   {{"replacing", &day01::solvePart2Replace}}}});
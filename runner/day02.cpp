@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day02 {
+#include "../2/solve.cpp"
+}
+
+static const DayRegistrar registrar(2, {{"Part 1", &day02::solvePart1},
+                                        {"Part 2", &day02::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day03 {
+#include "../3/solve.cpp"
+}
+
+static const DayRegistrar registrar(3, {{"Part 1", &day03::solvePart1},
+                                        {"Part 2", &day03::solvePart2}});
@@ -0,0 +1,11 @@
+#include "prelude.h"
+
+namespace day04 {
+#include "../4/solve.cpp"
+}
+
+static const DayRegistrar
+    registrar(4, {{"Part 1",
+                   &day04::solvePart1,
+                   {{"unordered_set", &day04::solvePart1Set}}},
+                  {"Part 2", &day04::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day05 {
+#include "../5/solve.cpp"
+}
+
+static const DayRegistrar registrar(5, {{"Part 1", &day05::solvePart1},
+                                        {"Part 2", &day05::solvePart2}});
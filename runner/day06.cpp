@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day06 {
+#include "../6/solve.cpp"
+}
+
+static const DayRegistrar registrar(6, {{"Part 1", &day06::solvePart1},
+                                        {"Part 2", &day06::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day07 {
+#include "../7/solve.cpp"
+}
+
+static const DayRegistrar registrar(7, {{"Part 1", &day07::solvePart1},
+                                        {"Part 2", &day07::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day08 {
+#include "../8/solve.cpp"
+}
+
+static const DayRegistrar registrar(8, {{"Part 1", &day08::solvePart1},
+                                        {"Part 2", &day08::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day09 {
+#include "../9/solve.cpp"
+}
+
+static const DayRegistrar registrar(9,
+                                    {{"Both parts", &day09::solveBothParts}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day10 {
+#include "../10/solve.cpp"
+}
+
+static const DayRegistrar registrar(10, {{"Part 1", &day10::solvePart1},
+                                         {"Part 2", &day10::solvePart2}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day11 {
+#include "../11/solve.cpp"
+}
+
+static const DayRegistrar registrar(11,
+                                    {{"Both parts", &day11::solveBothParts}});
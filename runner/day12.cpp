@@ -0,0 +1,13 @@
+#include "prelude.h"
+
+namespace day12 {
+#include "../12/solve.cpp"
+}
+
+static const DayRegistrar registrar(
+    12, {{"Part 1",
+          &day12::solvePart1<>,
+          {{"std::unordered_map", &day12::solvePart1<day12::StdMemo>}}},
+         {"Part 2",
+          &day12::solvePart2<>,
+          {{"std::unordered_map", &day12::solvePart2<day12::StdMemo>}}}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day13 {
+#include "../13/solve.cpp"
+}
+
+static const DayRegistrar registrar(13,
+                                    {{"Both parts", &day13::solveBothParts}});
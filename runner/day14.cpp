@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day14 {
+#include "../14/solve.cpp"
+}
+
+static const DayRegistrar registrar(14, {{"Part 1", &day14::solvePart1},
+                                         {"Part 2", &day14::solvePart2}});
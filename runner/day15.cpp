@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day15 {
+#include "../15/solve.cpp"
+}
+
+static const DayRegistrar registrar(15, {{"Part 1", &day15::solvePart1},
+                                         {"Part 2", &day15::solvePart2}});
@@ -0,0 +1,10 @@
+#include "prelude.h"
+
+namespace day16 {
+#include "../16/solve.cpp"
+}
+
+// Mapping the input is part of the measurement here.
+static const DayRegistrar registrar(
+    16, {{"Part 1", [] { day16::solvePart1(InputFile(inputPath).lines()); }},
+         {"Part 2", [] { day16::solvePart2(InputFile(inputPath).lines()); }}});
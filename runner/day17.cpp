@@ -0,0 +1,10 @@
+#include "prelude.h"
+
+namespace day17 {
+#include "../17/solve.cpp"
+}
+
+// Mapping the input is part of the measurement here.
+static const DayRegistrar registrar(
+    17, {{"Part 1", [] { day17::solvePart1(InputFile(inputPath).lines()); }},
+         {"Part 2", [] { day17::solvePart2(InputFile(inputPath).lines()); }}});
@@ -0,0 +1,8 @@
+#include "prelude.h"
+
+namespace day18 {
+#include "../18/solve.cpp"
+}
+
+static const DayRegistrar registrar(18, {{"Part 1", &day18::solvePart1},
+                                         {"Part 2", &day18::solvePart2}});
@@ -0,0 +1,12 @@
+#include "prelude.h"
+
+namespace day19 {
+#include "../19/solve.cpp"
+}
+
+static const DayRegistrar registrar(
+    19,
+    {{"Part 1",
+      &day19::solvePart1<>,
+      {{"std::unordered_map", &day19::solvePart1<day19::StdWorkflowMap>}}},
+     {"Part 2", &day19::solvePart2}});
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../common/bench.h"
+#include "registry.h"
+#include <string>
+#include <vector>
+
+// One day's run: the stats and output of its parts.
+struct Job {
+  const Day *day = nullptr;
+  std::vector<BenchStats> stats = {};
+  std::string output = {};
+  std::string error = {};
+  double wallMs = 0.0;
+};
+
+// Runs all parts of the job's day on the given input. The results are
+// recorded under the given group name, e.g. "Day 3".
+void runJob(Job &job, const std::string &input, const std::string &group);
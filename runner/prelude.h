@@ -0,0 +1,53 @@
+#pragma once
+
+// Included by each day's translation unit before the day's solve.cpp is pulled
+// into its own namespace. Everything a day includes must already be included
+// here. Otherwise the include guards don't kick in and the standard library
+// ends up inside the day's namespace.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../common/batch.h"
+#include "../common/bench.h"
+#include "../common/embed.h"
+#include "../common/flat_hash_map.h"
+#include "../common/input.h"
+#include "../common/line_reader.h"
+#include "../common/parse.h"
+#include "../common/parse_cache.h"
+#include "../common/thread_pool.h"
+
+#include "registry.h"
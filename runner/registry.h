@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Another way to solve a part, e.g. the straightforward solution an
+// optimization replaced. The runner's --compare checks that it prints the
+// same answer.
+struct Implementation {
+  std::string name;
+  std::function<void()> func;
+};
+
+struct Part {
+  std::string name;
+  std::function<void()> func;
+  // The first one is the reference the speedups are relative to.
+  std::vector<Implementation> alternatives = {};
+};
+
+struct Day {
+  int number;
+  std::vector<Part> parts;
+};
+
+inline std::vector<Day> &registry() {
+  static std::vector<Day> days;
+  return days;
+}
+
+// Each day's translation unit registers its parts with a static instance.
+struct DayRegistrar {
+  DayRegistrar(int number, std::vector<Part> parts) {
+    registry().push_back(Day{number, std::move(parts)});
+  }
+};
@@ -0,0 +1,114 @@
+#include "regressions.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+std::vector<HistoryRecord> loadBaseline(const BaselineOptions &options) {
+  const BenchEnvironment &env = benchEnvironment();
+  std::vector<HistoryRecord> ret;
+  for (auto &record : loadHistory(options.path)) {
+    if (record.build != env.build || record.cpu != env.cpu ||
+        record.commit.compare(0, options.commit.size(), options.commit) != 0) {
+      continue;
+    }
+    // Later records replace earlier ones of the same part.
+    const auto it =
+        std::find_if(ret.begin(), ret.end(), [&](const HistoryRecord &other) {
+          return other.group == record.group && other.name == record.name;
+        });
+    if (it != ret.end()) {
+      *it = std::move(record);
+    } else {
+      ret.push_back(std::move(record));
+    }
+  }
+  return ret;
+}
+
+// Quantile of Student's t-distribution for the one-sided 1% level, by the
+// Cornish-Fisher expansion around the normal quantile. Accurate to a few
+// percent from 3 degrees of freedom on.
+static double criticalT(double df) {
+  const double z = 2.326348;
+  const double z3 = z * z * z;
+  const double z5 = z3 * z * z;
+  const double z7 = z5 * z * z;
+  return z + (z3 + z) / (4.0 * df) +
+         (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df) +
+         (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / (384.0 * df * df * df);
+}
+
+// Welch's t statistic of the difference of the means and its degrees of
+// freedom.
+static std::pair<double, double> welch(const HistoryRecord &base,
+                                       const BenchStats &current) {
+  const double v0 = base.stddevMs * base.stddevMs / base.runs;
+  const double v1 = current.stddevMs * current.stddevMs / current.runs;
+  const double diff = current.meanMs - base.meanMs;
+  if (v0 + v1 <= 0.0) {
+    return {diff == 0.0 ? 0.0 : std::copysign(INFINITY, diff), INFINITY};
+  }
+  const double t = diff / std::sqrt(v0 + v1);
+  const double df = (v0 + v1) * (v0 + v1) /
+                    (v0 * v0 / (base.runs - 1) + v1 * v1 / (current.runs - 1));
+  return {t, df};
+}
+
+bool checkRegressions(const std::vector<Job> &jobs,
+                      const std::vector<HistoryRecord> &baseline,
+                      const BaselineOptions &options) {
+  std::ostringstream oss;
+  oss << std::left << std::setw(5) << "Day" << std::setw(12) << "Part"
+      << std::right << std::setw(12) << "Baseline" << std::setw(12)
+      << "Current" << std::setw(9) << "Change" << "  Verdict\n";
+  bool ok = true;
+  for (const auto &job : jobs) {
+    for (const auto &stats : job.stats) {
+      oss << std::left << std::setw(5) << job.day->number << std::setw(12)
+          << stats.name << std::right;
+      const auto base =
+          std::find_if(baseline.begin(), baseline.end(), [&](const auto &r) {
+            return r.group == stats.group && r.name == stats.name;
+          });
+      if (base == baseline.end()) {
+        oss << std::setw(12) << "-" << std::setw(12)
+            << formatDuration(stats.meanMs) << std::setw(9) << "-"
+            << "  no baseline\n";
+        continue;
+      }
+      const double change = stats.meanMs / std::max(base->meanMs, 1e-9) - 1;
+      oss << std::setw(12) << formatDuration(base->meanMs) << std::setw(12)
+          << formatDuration(stats.meanMs) << std::setw(8) << std::fixed
+          << std::setprecision(1) << std::showpos << change * 100.0 << "%"
+          << std::noshowpos << std::defaultfloat << "  ";
+      if (stats.cached) {
+        oss << "cached, not measured\n";
+        continue;
+      }
+      if (base->runs < 3 || stats.runs < 3) {
+        oss << "too few runs to tell\n";
+        continue;
+      }
+      // Noise mostly makes runs slower, the fastest run is the most stable
+      // number. It has to agree, otherwise a few slow runs (e.g. another
+      // process waking up) would count as regression.
+      const double minChange = stats.minMs / std::max(base->minMs, 1e-9) - 1;
+      const auto [t, df] = welch(*base, stats);
+      const bool significant = std::abs(t) > criticalT(df);
+      if (significant && change > options.threshold &&
+          minChange > options.threshold) {
+        oss << "REGRESSION\n";
+        ok = false;
+      } else if (significant && change < -options.threshold &&
+                 minChange < -options.threshold) {
+        oss << "improvement\n";
+      } else {
+        oss << "ok\n";
+      }
+    }
+  }
+  std::cout << oss.str();
+  return ok;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../common/history.h"
+#include "job.h"
+#include <string>
+#include <vector>
+
+struct BaselineOptions {
+  // History file (see AOC_BENCH_HISTORY) holding the baseline.
+  std::string path;
+  // Only records of commits starting with this are taken, default: any.
+  std::string commit;
+  // Slowdowns below this fraction aren't reported even if significant. Runs
+  // of the same binary already differ by a few percent.
+  double threshold = 0.1;
+};
+
+// Latest record per part in the baseline file that was measured with the same
+// build variant on the same CPU.
+std::vector<HistoryRecord> loadBaseline(const BaselineOptions &options);
+
+// Compares the stats of the jobs with the baseline and prints a table. A part
+// regressed if Welch's t-test says that it got slower at the 1% level and by
+// more than the threshold. Returns false if any part regressed.
+bool checkRegressions(const std::vector<Job> &jobs,
+                      const std::vector<HistoryRecord> &baseline,
+                      const BaselineOptions &options);
@@ -0,0 +1,405 @@
+#include "../common/bench.h"
+#include "../common/input.h"
+#include "../common/thread_pool.h"
+#include "batch.h"
+#include "compare.h"
+#include "job.h"
+#include "registry.h"
+#include "regressions.h"
+#include "scaling.h"
+#include "serve.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the registered days and prints an aggregated timing table.
+// Usage: ./runner [options] [days...]
+// Days are given as numbers or ranges like 3-7. Default is all days.
+// Options:
+//   -j <n>             Number of days running concurrently (default: cores).
+//                      The thread pool of the days gets the remaining cores
+//                      plus one (see configurePool()).
+//   --sequential       Same as -j 1.
+//   --quiet            Only print the table, not the output of the days.
+//   --root <dir>       Directory containing the day directories.
+//   --warmup <n>       See AOC_BENCH_WARMUP.
+//   --min-time-ms <t>  See AOC_BENCH_MIN_TIME_MS.
+//   --min-runs <n>     See AOC_BENCH_MIN_RUNS.
+//   --max-runs <n>     See AOC_BENCH_MAX_RUNS.
+//   --output <path>    See AOC_BENCH_OUTPUT.
+//   --history <path>   See AOC_BENCH_HISTORY.
+//   --baseline <path>  Compare the timings with the latest ones of the same
+//                      build and CPU in this history file and fail on
+//                      significant regressions.
+//                      --history and --baseline imply at least 5 runs per
+//                      part and --min-time-ms 200.
+//   --baseline-commit <rev>
+//                      Only take baseline records of this commit.
+//   --threshold <pct>  Smallest slowdown counted as regression (default 10).
+//   --result-cache <path>
+//                      See AOC_RESULT_CACHE. Cached parts show the time they
+//                      originally took.
+//   --trace <path>     See AOC_TRACE. Each day is one event on the thread
+//                      that ran it.
+//   --counters         See AOC_BENCH_COUNTERS. Adds IPC and LLC misses per
+//                      input byte to the table.
+//   --profile          Sample the measured runs and print a flat profile per
+//                      day after the table (see common/profiler.h).
+//   --scaling <s,...>  Run the days sequentially on generated inputs of the
+//                      given scales instead (see ../generators) and report
+//                      how the run time grows.
+//   --seed <n>         Seed for the generated inputs (default: 1).
+//   --budget-ms <t>    Stop scaling a day once a part took longer.
+//   --compare          Run the alternative implementations of the parts
+//                      instead, check that they give the same answers as the
+//                      reference and report their speedups.
+//   --batch <dir|manifest>
+//                      Solve all inputs in a directory or listed in a
+//                      manifest instead, -j of them at a time, and stream the
+//                      answers as JSON lines (see common/batch.h). Inputs
+//                      without a day in the manifest are solved by each of
+//                      the given days.
+//   --serve <socket>   Serve the days on this Unix domain socket instead,
+//                      answering requests on -j threads (see serve.h).
+
+struct Options {
+  unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  bool quiet = false;
+  std::filesystem::path root;
+  std::vector<int> days;
+  ScalingOptions scaling;
+  bool compare = false;
+  bool profile = false;
+  std::string batch;
+  std::string socketPath;
+  BaselineOptions baseline;
+};
+
+void printUsage() {
+  std::cerr << "Usage: runner [-j <n>] [--sequential] [--quiet] [--root <dir>] "
+               "[--warmup <n>] [--min-time-ms <t>] [--min-runs <n>] "
+               "[--max-runs <n>] [--output <path>] [--history <path>] "
+               "[--baseline <path>] [--baseline-commit <rev>] "
+               "[--threshold <pct>] [--result-cache <path>] [--trace <path>] "
+               "[--counters] [--profile] [--scaling <s,...>] [--seed <n>] "
+               "[--budget-ms <t>] [--compare] [--batch <dir|manifest>] "
+               "[--serve <socket>] [days...]\n";
+}
+
+void parseDays(const std::string &arg, std::vector<int> &days) {
+  const auto sepPos = arg.find('-');
+  if (sepPos == std::string::npos) {
+    days.push_back(std::stoi(arg));
+  } else {
+    const int first = std::stoi(arg.substr(0, sepPos));
+    const int last = std::stoi(arg.substr(sepPos + 1));
+    for (int day = first; day <= last; ++day) {
+      days.push_back(day);
+    }
+  }
+}
+
+Options parseOptions(int argc, char *argv[]) {
+  Options options;
+  // The runner lives in a directory next to the days.
+  options.root = std::filesystem::read_symlink("/proc/self/exe")
+                     .parent_path()
+                     .parent_path();
+  auto &config = benchConfig();
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto nextArg = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for " + arg + ".");
+      }
+      return argv[++i];
+    };
+    if (arg == "-j") {
+      options.threads = std::max(1, std::stoi(nextArg()));
+    } else if (arg == "--sequential") {
+      options.threads = 1;
+    } else if (arg == "--quiet") {
+      options.quiet = true;
+    } else if (arg == "--root") {
+      options.root = nextArg();
+    } else if (arg == "--warmup") {
+      config.warmups = std::max(0, std::stoi(nextArg()));
+    } else if (arg == "--min-time-ms") {
+      config.minTimeMs = std::max(0.0, std::stod(nextArg()));
+    } else if (arg == "--min-runs") {
+      config.minRuns = std::max(1, std::stoi(nextArg()));
+    } else if (arg == "--max-runs") {
+      config.maxRuns = std::max(1, std::stoi(nextArg()));
+    } else if (arg == "--output") {
+      config.setOutput(nextArg());
+    } else if (arg == "--history") {
+      config.historyPath = nextArg();
+    } else if (arg == "--baseline") {
+      options.baseline.path = nextArg();
+    } else if (arg == "--baseline-commit") {
+      options.baseline.commit = nextArg();
+    } else if (arg == "--threshold") {
+      options.baseline.threshold = std::stod(nextArg()) / 100.0;
+    } else if (arg == "--result-cache") {
+      config.resultCachePath = nextArg();
+    } else if (arg == "--trace") {
+      TraceRecorder::instance().setOutput(nextArg());
+    } else if (arg == "--counters") {
+      config.counters = true;
+    } else if (arg == "--profile") {
+      options.profile = true;
+    } else if (arg == "--scaling") {
+      std::istringstream iss(nextArg());
+      std::string scale;
+      while (std::getline(iss, scale, ',')) {
+        options.scaling.scales.push_back(std::stod(scale));
+      }
+    } else if (arg == "--seed") {
+      options.scaling.seed = std::stoull(nextArg());
+    } else if (arg == "--budget-ms") {
+      options.scaling.budgetMs = std::stod(nextArg());
+    } else if (arg == "--compare") {
+      options.compare = true;
+    } else if (arg == "--batch") {
+      options.batch = nextArg();
+    } else if (arg == "--serve") {
+      options.socketPath = nextArg();
+    } else if (arg == "-h" || arg == "--help") {
+      printUsage();
+      std::exit(0);
+    } else if (!arg.empty() && std::isdigit(arg[0])) {
+      parseDays(arg, options.days);
+    } else {
+      throw std::runtime_error("Unknown argument " + arg + ".");
+    }
+  }
+  if (!options.baseline.path.empty() || !config.historyPath.empty()) {
+    // A single run has no variance to test against. The history gets the same
+    // number of runs, so its records can serve as baseline.
+    config.minRuns = std::max(config.minRuns, 5);
+    config.maxRuns = std::max(config.maxRuns, config.minRuns);
+    config.minTimeMs = std::max(config.minTimeMs, 200.0);
+  }
+  return options;
+}
+
+std::vector<Job> createJobs(const Options &options) {
+  auto &days = registry();
+  std::sort(days.begin(), days.end(), [](const Day &lhs, const Day &rhs) {
+    return lhs.number < rhs.number;
+  });
+  std::vector<Job> jobs;
+  for (const auto &day : days) {
+    if (options.days.empty() ||
+        std::find(options.days.begin(), options.days.end(), day.number) !=
+            options.days.end()) {
+      jobs.push_back(Job{&day});
+    }
+  }
+  for (const int number : options.days) {
+    if (std::none_of(jobs.begin(), jobs.end(), [&](const Job &job) {
+          return job.day->number == number;
+        })) {
+      throw std::runtime_error("Day " + std::to_string(number) +
+                               " is not registered.");
+    }
+  }
+  return jobs;
+}
+
+void runJob(Job &job, const std::string &input, const std::string &group) {
+  inputPath = input;
+  benchGroup = group;
+  benchCollector = &job.stats;
+  ScopedOutput output(&job.output, false);
+  ScopedTimer timer(group, "day");
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    for (const auto &part : job.day->parts) {
+      measureTime(part.func, part.name);
+    }
+  } catch (const std::exception &e) {
+    job.error = e.what();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  job.wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+  benchCollector = nullptr;
+}
+
+// The days running concurrently share the thread pool. Together with its
+// workers they shouldn't need more threads than there are cores, so with -j
+// cores the days run their tasks inline. AOC_THREADS still overrides it.
+void configurePool(unsigned int numThreads) {
+  const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+  ThreadPool::configure(numThreads < cores ? cores - numThreads + 1 : 1);
+}
+
+// Simple pool: Each worker grabs the next job until there are none left.
+void runJobs(std::vector<Job> &jobs, const Options &options) {
+  std::atomic<size_t> nextJob{0};
+  const auto work = [&](unsigned int worker) {
+    TraceRecorder::instance().setThreadName("Worker " +
+                                            std::to_string(worker));
+    for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+      const std::string dir = std::to_string(jobs[i].day->number);
+      runJob(jobs[i], (options.root / dir / "input.txt").string(),
+             "Day " + dir);
+    }
+  };
+  const unsigned int numThreads =
+      std::min<unsigned int>(options.threads, jobs.size());
+  configurePool(numThreads);
+  if (numThreads <= 1) {
+    work(0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < numThreads; ++i) {
+    workers.emplace_back(work, i);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+// Counter value for the table, "-" if not available.
+std::string formatCounter(double value) {
+  if (value < 0.0) {
+    return "-";
+  }
+  std::ostringstream oss;
+  oss << std::setprecision(3) << value;
+  return oss.str();
+}
+
+void printTable(const std::vector<Job> &jobs, double wallMs) {
+  const bool counters = benchConfig().counters;
+  std::ostringstream oss;
+  oss << std::left << std::setw(5) << "Day" << std::setw(12) << "Part"
+      << std::right << std::setw(12) << "Median" << std::setw(7) << "Runs";
+  if (allocStatsEnabled) {
+    oss << std::setw(9) << "Allocs" << std::setw(11) << "Peak";
+  }
+  if (counters) {
+    oss << std::setw(7) << "IPC" << std::setw(9) << "LLC/B";
+  }
+  oss << "  " << "Answer\n";
+  double sumMs = 0.0;
+  bool partial = false;
+  for (const auto &job : jobs) {
+    for (const auto &stats : job.stats) {
+      oss << std::left << std::setw(5) << job.day->number << std::setw(12)
+          << stats.name << std::right << std::setw(12)
+          << formatDuration(stats.medianMs) << std::setw(7);
+      if (stats.cached) {
+        oss << "cached";
+      } else {
+        oss << stats.runs;
+      }
+      if (allocStatsEnabled) {
+        oss << std::setw(9) << std::llround(stats.allocs) << std::setw(11)
+            << formatBytes(static_cast<double>(stats.peakLiveBytes));
+      }
+      if (counters) {
+        // Partial counts are marked with a *.
+        const std::string mark = stats.countersPartial ? "*" : "";
+        oss << std::setw(7) << formatCounter(stats.counters.ipc()) + mark
+            << std::setw(9)
+            << formatCounter(perInputByte(stats, PerfEvent::LLC_MISSES)) +
+                   mark;
+        partial |= stats.countersPartial;
+      }
+      oss << "  " << summarizeOutput(stats.output) << "\n";
+    }
+    if (!job.error.empty()) {
+      oss << std::left << std::setw(5) << job.day->number << "Failed: "
+          << job.error << "\n";
+    }
+    sumMs += job.wallMs;
+  }
+  oss << "Sum of days: " << formatDuration(sumMs)
+      << ", wall clock: " << formatDuration(wallMs) << "\n";
+  if (partial) {
+    oss << "* Counted on the day's thread only, thread pool workers ran part "
+           "of the work (AOC_THREADS=1 counts everything).\n";
+  }
+  std::cout << oss.str();
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  std::vector<Job> jobs;
+  std::vector<HistoryRecord> baseline;
+  try {
+    options = parseOptions(argc, argv);
+    jobs = createJobs(options);
+    // Before running, the history file may be the baseline file.
+    if (!options.baseline.path.empty()) {
+      baseline = loadBaseline(options.baseline);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    printUsage();
+    return 1;
+  }
+  installOutputRouting();
+  if (!options.scaling.scales.empty()) {
+    runScaling(jobs, options.scaling);
+    const bool failed =
+        std::any_of(jobs.begin(), jobs.end(),
+                    [](const Job &job) { return !job.error.empty(); });
+    return failed ? 1 : 0;
+  }
+  if (options.compare) {
+    return runCompare(jobs, options.root) ? 0 : 1;
+  }
+  if (!options.socketPath.empty()) {
+    configurePool(options.threads);
+    return serve(jobs, options.socketPath, options.threads) ? 0 : 1;
+  }
+  if (!options.batch.empty()) {
+    configurePool(options.threads);
+    try {
+      return runBatchInputs(jobs, !options.days.empty(), options.batch,
+                            options.threads)
+                 ? 0
+                 : 1;
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << "\n";
+      return 1;
+    }
+  }
+  if (options.profile) {
+    SamplingProfiler::instance().start();
+  }
+  const auto start = std::chrono::steady_clock::now();
+  runJobs(jobs, options);
+  const auto end = std::chrono::steady_clock::now();
+  if (!options.quiet) {
+    for (const auto &job : jobs) {
+      std::cout << "=== Day " << job.day->number << " ===\n" << job.output;
+    }
+  }
+  printTable(jobs,
+             std::chrono::duration<double, std::milli>(end - start).count());
+  if (options.profile) {
+    SamplingProfiler::instance().report(std::cout);
+  }
+  bool failed =
+      std::any_of(jobs.begin(), jobs.end(),
+                  [](const Job &job) { return !job.error.empty(); });
+  if (!options.baseline.path.empty()) {
+    std::cout << "\nCompared with " << options.baseline.path << ":\n";
+    if (!checkRegressions(jobs, baseline, options.baseline)) {
+      failed = true;
+    }
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#include "scaling.h"
+#include "../generators/generators.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+struct Sample {
+  double scale;
+  double bytes;
+  double medianMs;
+};
+
+// Exponent k of time ~ size^k, fitted by least squares on the log-log
+// samples.
+static double fitExponent(const std::vector<Sample> &samples) {
+  double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+  for (const auto &s : samples) {
+    const double x = std::log(s.bytes);
+    const double y = std::log(std::max(s.medianMs, 1e-6));
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+  const double n = static_cast<double>(samples.size());
+  return (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+}
+
+static void printDay(const Job &job,
+                     const std::vector<std::vector<Sample>> &parts,
+                     const std::string &stopReason) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2);
+  for (size_t p = 0; p < parts.size(); ++p) {
+    const auto &samples = parts[p];
+    for (size_t i = 0; i < samples.size(); ++i) {
+      oss << std::left << std::setw(5) << job.day->number << std::setw(12)
+          << job.day->parts[p].name << std::right << std::setw(9)
+          << samples[i].scale << std::setw(13) << formatBytes(samples[i].bytes)
+          << std::setw(12) << formatDuration(samples[i].medianMs);
+      if (i > 0) {
+        // Local growth exponent between the last two sizes.
+        const std::vector<Sample> pair{samples[i - 1], samples[i]};
+        oss << "  n^" << fitExponent(pair);
+      }
+      oss << "\n";
+    }
+    if (samples.size() > 2) {
+      oss << std::left << std::setw(5) << job.day->number << std::setw(12)
+          << job.day->parts[p].name << "  fit: n^" << fitExponent(samples)
+          << "\n";
+    }
+  }
+  if (!stopReason.empty()) {
+    oss << std::left << std::setw(5) << job.day->number << stopReason << "\n";
+  }
+  std::cout << oss.str();
+}
+
+void runScaling(std::vector<Job> &jobs, const ScalingOptions &options) {
+  const fs::path dir = fs::temp_directory_path() / "aoc-scaling";
+  fs::create_directories(dir);
+  std::cout << std::left << std::setw(5) << "Day" << std::setw(12) << "Part"
+            << std::right << std::setw(9) << "Scale" << std::setw(13)
+            << "Input" << std::setw(12) << "Median" << "  Growth\n";
+  for (auto &job : jobs) {
+    const int number = job.day->number;
+    const Generator *generator = findGenerator(number);
+    if (!generator) {
+      std::cout << std::left << std::setw(5) << number << "No generator.\n";
+      continue;
+    }
+    std::vector<std::vector<Sample>> parts(job.day->parts.size());
+    std::string stopReason;
+    for (const double scale : options.scales) {
+      const fs::path input =
+          dir / ("day" + std::to_string(number) + ".txt");
+      {
+        // Same seed for every scale, so smaller inputs resemble larger ones.
+        Rng rng(options.seed);
+        std::ofstream ofs(input);
+        generator->func(ofs, scale, rng);
+      }
+      const double bytes = static_cast<double>(fs::file_size(input));
+      std::ostringstream scaleStr;
+      scaleStr << scale;
+      Job run{job.day};
+      runJob(run, input.string(),
+             "Day " + std::to_string(number) + " x" + scaleStr.str());
+      fs::remove(input);
+      for (size_t p = 0; p < run.stats.size(); ++p) {
+        parts[p].push_back(Sample{scale, bytes, run.stats[p].medianMs});
+      }
+      if (!run.error.empty()) {
+        stopReason = "Failed at scale " + scaleStr.str() + ": " + run.error;
+        job.error = run.error;
+        break;
+      }
+      const bool overBudget = std::any_of(
+          run.stats.begin(), run.stats.end(), [&](const BenchStats &stats) {
+            return stats.medianMs > options.budgetMs;
+          });
+      if (overBudget && scale != options.scales.back()) {
+        stopReason = "Stopped after scale " + scaleStr.str() +
+                     ", over the budget of " +
+                     formatDuration(options.budgetMs) + ".";
+        break;
+      }
+    }
+    printDay(job, parts, stopReason);
+  }
+}
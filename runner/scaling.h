@@ -0,0 +1,15 @@
+#pragma once
+
+#include "job.h"
+#include <vector>
+
+struct ScalingOptions {
+  std::vector<double> scales;
+  unsigned long long seed = 1;
+  // A day isn't run at larger scales once one of its parts took longer.
+  double budgetMs = 10000.0;
+};
+
+// Runs each day on generated inputs of growing size and reports how the run
+// time grows with the input size.
+void runScaling(std::vector<Job> &jobs, const ScalingOptions &options);
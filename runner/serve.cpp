@@ -0,0 +1,263 @@
+#include "serve.h"
+#include "../common/batch.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Buffered reading from and writing to a connected socket.
+class Connection {
+public:
+  explicit Connection(int fd_) : fd(fd_) {}
+  ~Connection() { ::close(fd); }
+
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  // Without the '\n'. False once the peer closed the connection.
+  bool readLine(std::string &line) {
+    while (true) {
+      const auto end = buffer.find('\n', pos);
+      if (end != std::string::npos) {
+        line = buffer.substr(pos, end - pos);
+        pos = end + 1;
+        return true;
+      }
+      if (!fill()) {
+        return false;
+      }
+    }
+  }
+
+  bool readBytes(size_t size, std::string &bytes) {
+    while (buffer.size() - pos < size) {
+      if (!fill()) {
+        return false;
+      }
+    }
+    bytes = buffer.substr(pos, size);
+    pos += size;
+    return true;
+  }
+
+  bool write(const std::string &data) {
+    for (size_t done = 0; done < data.size();) {
+      // No SIGPIPE if the client is gone.
+      const ssize_t n = ::send(fd, data.data() + done, data.size() - done,
+                               MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      done += n;
+    }
+    return true;
+  }
+
+private:
+  bool fill() {
+    buffer.erase(0, pos);
+    pos = 0;
+    char chunk[64 * 1024];
+    ssize_t n;
+    do {
+      n = ::recv(fd, chunk, sizeof(chunk), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+      return false;
+    }
+    buffer.append(chunk, n);
+    return true;
+  }
+
+  int fd;
+  std::string buffer;
+  size_t pos = 0;
+};
+
+// Input sent inline, in an anonymous file the days can open by its path
+// like any other input.
+class MemoryFile {
+public:
+  explicit MemoryFile(const std::string &data)
+      : fd(::memfd_create("input", MFD_CLOEXEC)) {
+    if (fd < 0) {
+      throw std::runtime_error("Failed to create a memory file.");
+    }
+    for (size_t done = 0; done < data.size();) {
+      const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+      if (n < 0 && errno != EINTR) {
+        ::close(fd);
+        throw std::runtime_error("Failed to write the memory file.");
+      }
+      done += std::max<ssize_t>(n, 0);
+    }
+  }
+  ~MemoryFile() { ::close(fd); }
+
+  MemoryFile(const MemoryFile &) = delete;
+  MemoryFile &operator=(const MemoryFile &) = delete;
+
+  std::string path() const { return "/proc/self/fd/" + std::to_string(fd); }
+
+private:
+  int fd;
+};
+
+using DayParts = std::map<int, std::vector<BatchPart>>;
+
+std::string errorResponse(const std::string &message) {
+  return "{\"error\":\"" + jsonEscape(message) + "\"}\n\n";
+}
+
+// Reads the inline input of the request if any and solves it. Returns false
+// if the connection broke.
+bool handleRequest(Connection &conn, const std::string &line,
+                   const DayParts &days) {
+  std::istringstream iss(line);
+  int day = 0;
+  std::string part;
+  std::string source;
+  iss >> day >> part >> std::ws;
+  std::getline(iss, source);
+  std::string data;
+  bool inlineInput = false;
+  if (!source.empty() && source[0] == '-') {
+    size_t size = 0;
+    try {
+      size = std::stoull(source.substr(1));
+    } catch (const std::exception &) {
+      return conn.write(errorResponse("Bad size in \"" + line + "\"."));
+    }
+    if (!conn.readBytes(size, data)) {
+      return false;
+    }
+    inlineInput = true;
+  }
+  const auto it = days.find(day);
+  if (it == days.end()) {
+    return conn.write(errorResponse("Day " + std::to_string(day) +
+                                    " is not served."));
+  }
+  std::vector<BatchPart> parts;
+  if (part == "all") {
+    parts = it->second;
+  } else {
+    const size_t index = std::strtoul(part.c_str(), nullptr, 10);
+    if (index < 1 || index > it->second.size()) {
+      return conn.write(errorResponse("Day " + std::to_string(day) +
+                                      " has no part " + part + "."));
+    }
+    parts.push_back(it->second[index - 1]);
+  }
+  if (source.empty()) {
+    return conn.write(errorResponse("No input in \"" + line + "\"."));
+  }
+  bool ok = true;
+  std::string response;
+  try {
+    if (inlineInput) {
+      const MemoryFile file(data);
+      response = solveBatchTask(BatchTask{file.path(), day, &parts, "-"}, ok);
+    } else {
+      response = solveBatchTask(BatchTask{source, day, &parts}, ok);
+    }
+  } catch (const std::exception &e) {
+    return conn.write(errorResponse(e.what()));
+  }
+  return conn.write(response + "\n");
+}
+
+void serveConnections(int listenFd, const DayParts &days) {
+  while (true) {
+    const int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      std::cerr << "accept failed: " << std::strerror(errno) << "\n";
+      return;
+    }
+    Connection conn(fd);
+    std::string line;
+    while (conn.readLine(line)) {
+      if (!line.empty() && !handleRequest(conn, line, days)) {
+        break;
+      }
+    }
+  }
+}
+
+// For removing the socket on SIGINT / SIGTERM.
+char socketToRemove[sizeof(sockaddr_un::sun_path)];
+
+void removeSocketAndExit(int) {
+  ::unlink(socketToRemove);
+  ::_exit(0);
+}
+
+} // namespace
+
+bool serve(const std::vector<Job> &jobs, const std::string &socketPath,
+           unsigned int numThreads) {
+  DayParts days;
+  for (const auto &job : jobs) {
+    auto &parts = days[job.day->number];
+    for (const auto &part : job.day->parts) {
+      parts.push_back(BatchPart{part.name, part.func});
+    }
+  }
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  if (socketPath.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "Socket path " << socketPath << " is too long.\n";
+    return false;
+  }
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, socketPath.c_str());
+  const int listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  // A socket left behind by a killed daemon would make bind() fail.
+  struct stat st;
+  if (::stat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+    ::unlink(socketPath.c_str());
+  }
+  if (listenFd < 0 ||
+      ::bind(listenFd, reinterpret_cast<const sockaddr *>(&addr),
+             sizeof(addr)) != 0 ||
+      ::listen(listenFd, SOMAXCONN) != 0) {
+    std::cerr << "Failed to listen on " << socketPath << ": "
+              << std::strerror(errno) << "\n";
+    return false;
+  }
+  std::strcpy(socketToRemove, addr.sun_path);
+  std::signal(SIGINT, removeSocketAndExit);
+  std::signal(SIGTERM, removeSocketAndExit);
+  numThreads = std::max(1u, numThreads);
+  std::cerr << "Serving " << days.size() << " days on " << socketPath
+            << " with " << numThreads
+            << (numThreads == 1 ? " thread.\n" : " threads.\n");
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < numThreads; ++i) {
+    workers.emplace_back(serveConnections, listenFd, std::cref(days));
+  }
+  serveConnections(listenFd, days);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  ::close(listenFd);
+  ::unlink(socketPath.c_str());
+  return true;
+}
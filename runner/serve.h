@@ -0,0 +1,19 @@
+#pragma once
+
+#include "job.h"
+#include <string>
+#include <vector>
+
+// Serves the days of the jobs on a Unix domain socket until terminated, so a
+// pipeline solving many inputs doesn't start a process per input. Each of the
+// numThreads workers serves one connection at a time, keeping its arena and
+// the shared thread pool warm across requests.
+// A connection sends any number of requests, each a line
+//   <day> <part> <path>        e.g. "8 1 /data/input.txt"
+//   <day> <part> -<size>       followed by <size> bytes of input
+// where part is the 1-based index of the day's part or "all". The response
+// per request is a JSON line per part as in batch mode (see common/batch.h),
+// or {"error":...} for a malformed request, followed by an empty line.
+// Returns false if the socket can't be set up.
+bool serve(const std::vector<Job> &jobs, const std::string &socketPath,
+           unsigned int numThreads);
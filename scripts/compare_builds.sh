@@ -0,0 +1,80 @@
+#!/bin/bash
+# Builds the days in each variant of their Makefile (debug, release, lto, pgo)
+# and reports the median time of each part per variant and the speedup over
+# the debug build.
+# Usage: scripts/compare_builds.sh [days...]
+# Environment:
+#   VARIANTS      Variants to compare (default: "debug release lto pgo").
+#   TRAIN_SCALE   Train PGO on an input generated at this scale (see
+#                 ../generators) instead of the day's input.txt, so the
+#                 profile isn't fitted to the measured input.
+#   AOC_BENCH_*   Passed on to the runs, e.g. AOC_BENCH_MIN_TIME_MS=500.
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+days=("$@")
+if [ ${#days[@]} -eq 0 ]; then
+  days=($(seq 1 19))
+fi
+variants=(${VARIANTS:-debug release lto pgo})
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+if [ -n "${TRAIN_SCALE:-}" ]; then
+  make -s -C "$root/generators" >&2
+fi
+
+for day in "${days[@]}"; do
+  dir="$root/$day"
+  train="$dir"
+  if [ -n "${TRAIN_SCALE:-}" ]; then
+    train="$work/train-$day"
+    mkdir -p "$train"
+    "$root/generators/gen" "$day" --scale "$TRAIN_SCALE" --seed 2 \
+      --output "$train/input.txt"
+  fi
+  for variant in "${variants[@]}"; do
+    echo "Day $day: $variant" >&2
+    make -s -C "$dir" BUILD="$variant" TRAIN_DIR="$train" >&2
+    binary=solve
+    if [ "$variant" != debug ]; then
+      binary=solve-$variant
+    fi
+    (cd "$dir" && AOC_BENCH_OUTPUT="$work/$variant.csv" \
+      AOC_BENCH_FORMAT=csv "./$binary" > /dev/null)
+  done
+done
+
+# Joins the records on day and part. Column 6 of the CSV is median_ms.
+awk -F, -v variants="${variants[*]}" '
+  BEGIN { n = split(variants, names, " ") }
+  FNR == 1 {
+    # Header. The file tells the variant.
+    for (i = 1; i <= n; ++i) {
+      if (FILENAME ~ "/" names[i] ".csv$") v = i
+    }
+    next
+  }
+  {
+    key = $1 SUBSEP $2
+    if (!(key in seen)) { seen[key] = 1; keys[++numKeys] = key }
+    median[key, v] = $6
+  }
+  END {
+    printf "%-5s %-8s", "Day", "Part"
+    for (i = 1; i <= n; ++i) printf " %18s", names[i]
+    printf "\n"
+    for (k = 1; k <= numKeys; ++k) {
+      split(keys[k], parts, SUBSEP)
+      printf "%-5s %-8s", parts[1], parts[2]
+      base = median[keys[k], 1]
+      for (i = 1; i <= n; ++i) {
+        ms = median[keys[k], i]
+        if (ms == "") { printf " %18s", "-"; continue }
+        cell = sprintf("%.3f ms", ms)
+        if (i > 1 && ms > 0) cell = cell sprintf(" %5.1fx", base / ms)
+        printf " %18s", cell
+      }
+      printf "\n"
+    }
+  }' $(for variant in "${variants[@]}"; do echo "$work/$variant.csv"; done)
@@ -0,0 +1,15 @@
+#!/bin/sh
+# Writes a header with the given input as a constexpr string for the
+# embedded build (make EMBED=1, see ../common/embed.h).
+# Usage: scripts/embed_input.sh input.txt > input_embed.h
+set -eu
+
+delim=aoc_input
+if grep -qF ")$delim\"" "$1"; then
+  echo "$1 contains the delimiter of the raw string." >&2
+  exit 1
+fi
+printf '#pragma once\n\n// Generated from %s by scripts/embed_input.sh.\n' "$1"
+printf 'constexpr char embeddedInputData[] = R"%s(' "$delim"
+cat "$1"
+printf ')%s";\n' "$delim"
@@ -0,0 +1,72 @@
+#!/bin/bash
+# Runs the days with the arena on normal pages and on huge pages (see
+# common/huge_pages.h) and reports the median time and the dTLB load misses
+# per run of each part per mode.
+# Usage: scripts/huge_pages_report.sh [days...]   (default: 8 17)
+# Environment:
+#   MODES         AOC_HUGE_PAGES values to compare (default: "0 thp hugetlb").
+#   BUILD         Variant of the day Makefiles to run (default: debug).
+#   AOC_BENCH_*   Passed on to the runs, e.g. AOC_BENCH_MIN_TIME_MS=500.
+# The misses need hardware counters (see common/perf_counters.h) and show as
+# "-" where perf_event_open isn't available.
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+days=("$@")
+if [ ${#days[@]} -eq 0 ]; then
+  days=(8 17)
+fi
+modes=(${MODES:-0 thp hugetlb})
+build=${BUILD:-debug}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+for day in "${days[@]}"; do
+  dir="$root/$day"
+  make -s -C "$dir" BUILD="$build" >&2
+  binary=solve
+  if [ "$build" != debug ]; then
+    binary=solve-$build
+  fi
+  for mode in "${modes[@]}"; do
+    echo "Day $day: AOC_HUGE_PAGES=$mode" >&2
+    (cd "$dir" && AOC_HUGE_PAGES="$mode" AOC_BENCH_COUNTERS=1 \
+      AOC_BENCH_OUTPUT="$work/$mode.csv" AOC_BENCH_FORMAT=csv \
+      "./$binary" > /dev/null)
+  done
+done
+
+# Joins the records on day and part. The header of each file tells the
+# columns, which depend on the build.
+awk -F, -v modes="${modes[*]}" '
+  BEGIN { n = split(modes, names, " ") }
+  FNR == 1 {
+    for (i = 1; i <= n; ++i) {
+      if (FILENAME ~ "/" names[i] ".csv$") m = i
+    }
+    for (i = 1; i <= NF; ++i) column[$i] = i
+    next
+  }
+  {
+    key = $1 SUBSEP $2
+    if (!(key in seen)) { seen[key] = 1; keys[++numKeys] = key }
+    median[key, m] = $column["median_ms"]
+    misses[key, m] = $column["dtlb_misses"]
+  }
+  END {
+    printf "%-5s %-8s", "Day", "Part"
+    for (i = 1; i <= n; ++i) printf " %26s", "AOC_HUGE_PAGES=" names[i]
+    printf "\n"
+    for (k = 1; k <= numKeys; ++k) {
+      split(keys[k], parts, SUBSEP)
+      printf "%-5s %-8s", parts[1], parts[2]
+      for (i = 1; i <= n; ++i) {
+        ms = median[keys[k], i]
+        if (ms == "") { printf " %26s", "-"; continue }
+        tlb = misses[keys[k], i]
+        tlb = tlb == "" ? "-" : sprintf("%.3g", tlb)
+        printf " %26s", sprintf("%.3f ms %10s dTLB", ms, tlb)
+      }
+      printf "\n"
+    }
+  }' $(for mode in "${modes[@]}"; do echo "$work/$mode.csv"; done)
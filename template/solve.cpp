@@ -1,22 +1,23 @@
 #include <iostream>
-#include <fstream>
 #include <string>
+#include <string_view>
 #include "utils.h"
 
 void solvePart1() {
-  std::ifstream ifs("input.txt");
-  std::vector<std::string> lines;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    lines.push_back(line);
-  }
+  const InputFile input(inputPath);
+  const auto &lines = input.lines();
 }
 
 void solvePart2() {
   // TODO
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (isBatchMode(argc, argv)) {
+    return batchMain(argc, argv,
+                     {{"Part 1", &solvePart1}, {"Part 2", &solvePart2}});
+  }
+  setInputPath(argc, argv);
   measureTime(&solvePart1, "Part 1");
   measureTime(&solvePart2, "Part 2");
   std::cout << "Done.\n";